@@ -0,0 +1,166 @@
+// Checks that fused skeleton bits are bit identical to cv::ximgproc::thinning of thresholded grayscale image
+
+#include <thinning/thinning.h>
+#include <ogr_components/preprocessed_graph.h>
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/ximgproc.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace {
+    constexpr size_t kImagesCount = 300;
+    constexpr int kMaxRows = 150;
+    constexpr int kMaxColumns = 200;
+    constexpr int kMaxBlobs = 30;
+
+    // Tiles with halo narrower than image, strokes are thinner than halo
+    constexpr size_t kTileSize = 32;
+    constexpr size_t kTileHalo = 24;
+    constexpr size_t kStrokesImagesCount = 100;
+    constexpr int kMinStrokesRows = 150;
+    constexpr int kMinStrokesColumns = 200;
+    constexpr int kMaxStrokeWidth = 16;
+    constexpr int kMaxStrokeLength = 60;
+
+    /** Dark or near threshold blob with random holes to get branchy skeletons */
+    void DrawBlob(cv::Mat& image, std::mt19937& rng, const int height, const int width) {
+        const int top = static_cast<int>(rng() % image.rows);
+        const int left = static_cast<int>(rng() % image.cols);
+        const int bottom = std::min(image.rows, top + height);
+        const int right = std::min(image.cols, left + width);
+        const uint8_t value = rng() % 2 ? 0 : static_cast<uint8_t>(240 + rng() % 16);
+
+        for (int row = top; row < bottom; ++row) {
+            for (int column = left; column < right; ++column) {
+                if (rng() % 10) {
+                    const uint8_t green = rng() % 2 ? value : 255;
+                    image.at<cv::Vec3b>(row, column) = cv::Vec3b(value, green, value);
+                }
+            }
+        }
+    }
+
+    /** White image of random size with random blobs */
+    cv::Mat MakeRandomImage(std::mt19937& rng) {
+        const int rows = 1 + static_cast<int>(rng() % kMaxRows);
+        const int columns = 1 + static_cast<int>(rng() % kMaxColumns);
+        cv::Mat image(rows, columns, CV_8UC3, cv::Scalar(255, 255, 255));
+
+        const int blobs = static_cast<int>(rng() % kMaxBlobs);
+        for (int blob = 0; blob < blobs; ++blob) {
+            const int height = 1 + static_cast<int>(rng() % 20);
+            const int width = 1 + static_cast<int>(rng() % 40);
+            DrawBlob(image, rng, height, width);
+        }
+
+        return image;
+    }
+
+    /** Image of several tiles with horizontal and vertical strokes not wider than max stroke width */
+    cv::Mat MakeStrokesImage(std::mt19937& rng) {
+        const int rows = kMinStrokesRows + static_cast<int>(rng() % kMaxRows);
+        const int columns = kMinStrokesColumns + static_cast<int>(rng() % kMaxColumns);
+        cv::Mat image(rows, columns, CV_8UC3, cv::Scalar(255, 255, 255));
+
+        const int strokes = static_cast<int>(rng() % kMaxBlobs);
+        for (int stroke = 0; stroke < strokes; ++stroke) {
+            const int width = 1 + static_cast<int>(rng() % kMaxStrokeWidth);
+            const int length = 1 + static_cast<int>(rng() % kMaxStrokeLength);
+            if (rng() % 2) {
+                DrawBlob(image, rng, width, length);
+            } else {
+                DrawBlob(image, rng, length, width);
+            }
+        }
+
+        return image;
+    }
+
+    cv::Mat GetReferenceSkeleton(const cv::Mat& colored_image) {
+        cv::Mat grayscale_image;
+        cv::cvtColor(colored_image, grayscale_image, cv::COLOR_BGR2GRAY);
+
+        cv::Mat binary_image;
+        cv::threshold(grayscale_image, binary_image, ogr::thinning::kThinningThreshold, 255, cv::THRESH_BINARY_INV);
+
+        cv::Mat skeleton;
+        cv::ximgproc::thinning(binary_image, skeleton);
+        return skeleton;
+    }
+
+    /** Description of first differing pixel, padding bits after last column should be clear */
+    std::optional<std::string> FindMismatch(const cv::Mat& reference, const std::vector<uint64_t>& bits) {
+        const size_t words_per_row = ogr::PreprocessedGraph::WordsPerRow(reference.cols);
+        if (bits.size() != words_per_row * reference.rows) {
+            return "bits size " + std::to_string(bits.size());
+        }
+
+        for (int row = 0; row < reference.rows; ++row) {
+            for (size_t column = 0; column < words_per_row * 64; ++column) {
+                const bool expected = static_cast<int>(column) < reference.cols && reference.at<uint8_t>(row, static_cast<int>(column)) != 0;
+                const bool actual = (bits[row * words_per_row + column / 64] >> (column % 64)) & 1;
+                if (expected != actual) {
+                    return "pixel (" + std::to_string(row) + ", " + std::to_string(column) + ")";
+                }
+            }
+        }
+
+        return std::nullopt;
+    }
+}
+
+int main() {
+    std::mt19937 rng(7);
+    size_t mismatches = 0;
+
+    for (size_t index = 0; index < kImagesCount; ++index) {
+        const cv::Mat image = MakeRandomImage(rng);
+        const cv::Mat reference = GetReferenceSkeleton(image);
+
+        for (const size_t threads : {1, 3}) {
+            const std::optional<std::string> mismatch = FindMismatch(reference, ogr::thinning::GetSkeletonBits(image, threads));
+            if (mismatch.has_value()) {
+                ++mismatches;
+                std::cerr << "Image " << index << " (" << image.rows << "x" << image.cols << "), threads " << threads
+                          << ": skeleton differs at " << *mismatch << std::endl;
+            }
+        }
+
+        // Halo covers whole image, so tiles see same neighbourhood as whole image thinning
+        const size_t halo = std::max(image.rows, image.cols);
+        const std::optional<std::string> mismatch = FindMismatch(reference, ogr::thinning::GetTiledSkeletonBits(image, 32, halo, 3));
+        if (mismatch.has_value()) {
+            ++mismatches;
+            std::cerr << "Image " << index << " (" << image.rows << "x" << image.cols << "), tiled: skeleton differs at "
+                      << *mismatch << std::endl;
+        }
+    }
+
+    // Tiles see only halo of their neighbourhood, skeleton should match while strokes are thinner than halo
+    for (size_t index = 0; index < kStrokesImagesCount; ++index) {
+        const cv::Mat image = MakeStrokesImage(rng);
+        const std::optional<std::string> mismatch = FindMismatch(
+                GetReferenceSkeleton(image), ogr::thinning::GetTiledSkeletonBits(image, kTileSize, kTileHalo, 3));
+        if (mismatch.has_value()) {
+            ++mismatches;
+            std::cerr << "Strokes image " << index << " (" << image.rows << "x" << image.cols << "), tiled with halo "
+                      << kTileHalo << ": skeleton differs at " << *mismatch << std::endl;
+        }
+    }
+
+    if (mismatches != 0) {
+        std::cerr << mismatches << " skeletons differ from cv::ximgproc::thinning" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All " << kImagesCount + kStrokesImagesCount << " skeletons are identical to cv::ximgproc::thinning" << std::endl;
+    return 0;
+}
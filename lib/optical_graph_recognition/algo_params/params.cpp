@@ -1,7 +0,0 @@
-#include "params.h"
-
-namespace ogr {
-    double kStableStateAngleDiffLocalThreshold = 10.5;
-    double kStableStateAngleDiffThreshold = 15.0;
-    double kAngleDiffThreshold = 40.0;
-}
\ No newline at end of file
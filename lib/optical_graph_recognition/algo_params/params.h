@@ -1,7 +1,43 @@
 #pragma once
 
+#include <utils/geometry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
 namespace ogr {
-    extern double kStableStateAngleDiffLocalThreshold;
-    extern double kStableStateAngleDiffThreshold;
-    extern double kAngleDiffThreshold;
-}
\ No newline at end of file
+    /**
+     * Angle thresholds of edges detection. Params are passed explicitly to every run,
+     * so images with different params can be processed concurrently.
+     */
+    struct AlgoParams {
+        // Max diff angle between consecutive steps of stable edge part
+        utils::BinaryAngle stable_state_angle_diff_local_threshold = utils::BinaryAngle::FromDegrees(10.5);
+        // Max diff angle between consecutive stable edge parts
+        utils::BinaryAngle stable_state_angle_diff_threshold = utils::BinaryAngle::FromDegrees(15.0);
+        // Max diff angle between crawler states separated by sub path
+        utils::BinaryAngle angle_diff_threshold = utils::BinaryAngle::FromDegrees(40.0);
+
+        /** Params are set in degrees */
+        static AlgoParams FromDegrees(const double curvature, const double stable_diff, const double state_diff) {
+            return AlgoParams{
+                .stable_state_angle_diff_local_threshold = ThresholdFromDegrees(curvature),
+                .stable_state_angle_diff_threshold = ThresholdFromDegrees(stable_diff),
+                .angle_diff_threshold = ThresholdFromDegrees(state_diff)
+            };
+        }
+
+        /**
+         * Diff of angles is at most half turn, so thresholds are clamped to it instead of wrapping around:
+         * half turn threshold accepts any diff.
+         */
+        static utils::BinaryAngle ThresholdFromDegrees(const double degrees) {
+            if (!std::isfinite(degrees) || degrees < 0) {
+                throw std::runtime_error{"Angle threshold should be non negative finite number of degrees"};
+            }
+
+            return utils::BinaryAngle::FromDegrees(std::min(degrees, 180.0));
+        }
+    };
+}
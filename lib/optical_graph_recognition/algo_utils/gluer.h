@@ -1,71 +1,92 @@
 #pragma once
 
 #include <ogr_components/matrix.h>
+#include <ogr_components/skeleton_index.h>
 #include <utils/disjoint_set.h>
 
-#include <unordered_map>
+#include <limits>
 #include <vector>
-#include <memory>
 
 
 namespace ogr::algo {
+    /**
+     * Glues added skeleton points into connected groups.
+     * Points are identified by their rank in skeleton index, so union-find is kept in flat arrays.
+     * Group ids are dense and given in order of first GetGroupId calls, which should follow all AddPoint calls.
+     */
     template <typename Neighbourhood>
     class PointsGluer {
-        using Set = utils::DisjointSet;
-        using SetId = uint64_t;
-        using SetPtr = std::unique_ptr<Set>;
+        static constexpr uint32_t kNoGroup = std::numeric_limits<uint32_t>::max();
 
     public:
-        explicit PointsGluer(matrix::Grm& grm) : grm_(grm) {}
+        PointsGluer(const matrix::Grm& grm, const matrix::SkeletonIndex& skeleton)
+            : grm_(grm)
+            , skeleton_(skeleton)
+            , sets_(skeleton.Size())
+            , added_(skeleton.Size(), 0)
+            , group_ids_(skeleton.Size(), kNoGroup) {
+        }
+
+        void AddPoint(const point::Point& point) {
+            const uint32_t index = IndexOf(point);
+            if (added_[index]) {
+                return;
+            }
 
-        void AddPoint(point::PointPtr point) {
-            static SetId set_counter = 0;
+            added_[index] = 1;
             points_.push_back(point);
 
-            std::vector<Set*> sets;
-            for (const point::PointPtr neighbour : ngh_(point, grm_)) {
-                if (points_map_.contains(neighbour.get())) {
-                    sets.push_back(points_map_[neighbour.get()].get());
+            for (const point::Point& neighbour : ngh_(point, grm_)) {
+                const std::optional<size_t> neighbour_index = skeleton_.Find(neighbour.row, neighbour.column);
+                if (neighbour_index.has_value() && added_[*neighbour_index]) {
+                    sets_.Union(index, static_cast<uint32_t>(*neighbour_index));
                 }
             }
-
-            SetPtr new_set = std::make_unique<Set>(set_counter++);
-            if (!sets.empty()) {
-                sets.push_back(new_set.get());
-                utils::MergeDisjointSets(sets);
-            }
-
-            points_map_[point.get()] = std::move(new_set);
         }
 
-        uint64_t GetGroupId(point::PointPtr point) {
+        uint64_t GetGroupId(const point::Point& point) {
             if (!ContainsPoint(point)) {
                 throw std::runtime_error{"Gluer does not contain point"};
             }
 
-            SetId set_id = points_map_[point.get()]->GetId();
-            if (!ids_.contains(set_id)) {
-                ids_[set_id] = group_id_counter_++;
+            uint32_t& group_id = group_ids_[sets_.Find(IndexOf(point))];
+            if (group_id == kNoGroup) {
+                group_id = group_id_counter_++;
             }
 
-            return ids_[set_id];
+            return group_id;
         }
 
-        const std::vector<point::PointPtr>& GetPoints() const {
+        const std::vector<point::Point>& GetPoints() const {
             return points_;
         }
 
-        bool ContainsPoint(point::PointPtr point) const {
-            return points_map_.contains(point.get());
+        bool ContainsPoint(const point::Point& point) const {
+            const std::optional<size_t> index = skeleton_.Find(point.row, point.column);
+            return index.has_value() && added_[*index];
         }
 
     private:
-        matrix::Grm& grm_;
+        uint32_t IndexOf(const point::Point& point) const {
+            const std::optional<size_t> index = skeleton_.Find(point.row, point.column);
+            if (!index.has_value()) {
+                throw std::runtime_error{"Glued point is not skeleton point"};
+            }
+
+            return static_cast<uint32_t>(*index);
+        }
+
+    private:
+        const matrix::Grm& grm_;
+        const matrix::SkeletonIndex& skeleton_;
         Neighbourhood ngh_;
-        std::unordered_map<point::Point*, SetPtr> points_map_;
-        std::vector<point::PointPtr> points_;
 
-        std::unordered_map<SetId, uint64_t> ids_;
-        uint64_t group_id_counter_{0};
+        utils::DisjointSets sets_;
+        std::vector<uint8_t> added_;
+        std::vector<point::Point> points_;
+
+        // Group id of every union-find root
+        std::vector<uint32_t> group_ids_;
+        uint32_t group_id_counter_{0};
     };
-}
\ No newline at end of file
+}
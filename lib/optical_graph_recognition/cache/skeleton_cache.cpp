@@ -0,0 +1,245 @@
+#include "skeleton_cache.h"
+
+#include <plog/Log.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+
+namespace ogr::cache {
+    namespace {
+        constexpr char kMagic[8] = {'O', 'G', 'R', 'S', 'K', 'E', 'L', '\0'};
+        // Version 2: inc usage is count of ink pixels
+        constexpr uint32_t kFormatVersion = 2;
+        const std::string kEntryExtension = ".skel";
+
+        struct EntryHeader {
+            char magic[8];
+            uint32_t version;
+            uint32_t rows;
+            uint32_t columns;
+            uint32_t reserved;
+            uint64_t inc_usage;
+            uint64_t skeleton_words;
+            uint64_t vertex_pixels;
+        };
+
+        // Skeleton words follow header without padding
+        static_assert(sizeof(EntryHeader) % alignof(uint64_t) == 0);
+
+        /** FNV-1a */
+        uint64_t Hash(std::span<const uint8_t> bytes, uint64_t hash = 14695981039346656037ull) {
+            for (const uint8_t byte : bytes) {
+                hash ^= byte;
+                hash *= 1099511628211ull;
+            }
+
+            return hash;
+        }
+
+        /** Everything recognition restoring relies on: skeleton fits into image and vertex pixels are skeleton points */
+        void CheckGraph(const PreprocessedGraph& graph) {
+            const size_t words_per_row = PreprocessedGraph::WordsPerRow(graph.columns);
+            if (graph.skeleton_bits.size() != graph.rows * words_per_row) {
+                throw std::runtime_error{"Invalid skeleton bits size"};
+            }
+
+            const uint64_t padding = graph.columns % 64 ? ~uint64_t{0} << (graph.columns % 64) : 0;
+            for (size_t row = 0; row < graph.rows && words_per_row; ++row) {
+                if (graph.skeleton_bits[(row + 1) * words_per_row - 1] & padding) {
+                    throw std::runtime_error{"Skeleton point out of image"};
+                }
+            }
+
+            for (const VertexPixel& pixel : graph.vertex_pixels) {
+                if (pixel.row >= graph.rows || pixel.column >= graph.columns) {
+                    throw std::runtime_error{"Vertex pixel out of image"};
+                }
+
+                const uint64_t word = graph.skeleton_bits[pixel.row * words_per_row + (pixel.column >> 6)];
+                if (!(word >> (pixel.column & 63) & 1)) {
+                    throw std::runtime_error{"Vertex pixel is not skeleton point"};
+                }
+            }
+        }
+    }
+
+    SkeletonCache::SkeletonCache(std::filesystem::path dir, const uintmax_t max_size_bytes)
+        : dir_(std::move(dir))
+        , max_size_bytes_(max_size_bytes) {
+        std::filesystem::create_directories(dir_);
+    }
+
+    std::string SkeletonCache::MakeKey(std::span<const uint8_t> image_bytes, std::string_view preprocessing_params) {
+        const std::string params = std::string{preprocessing_params} + ";format=" + std::to_string(kFormatVersion);
+        const uint64_t params_hash = Hash({reinterpret_cast<const uint8_t*>(params.data()), params.size()});
+
+        std::stringstream ss;
+        ss << std::hex << Hash(image_bytes, params_hash) << "-" << std::dec << image_bytes.size();
+        return ss.str();
+    }
+
+    std::optional<CacheEntry> SkeletonCache::Load(const std::string& key) {
+        const std::filesystem::path path = EntryPath(key);
+
+        // Mapping stays valid even if entry is evicted or replaced meanwhile
+        auto file = std::make_unique<utils::MappedFile>(path);
+        if (!file->Data()) {
+            return std::nullopt;
+        }
+
+        std::optional<CacheEntry> entry;
+        try {
+            if (file->Size() < sizeof(EntryHeader)) {
+                throw std::runtime_error{"Truncated header"};
+            }
+
+            EntryHeader header{};
+            std::memcpy(&header, file->Data(), sizeof(header));
+
+            if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion) {
+                throw std::runtime_error{"Unknown entry format"};
+            }
+
+            const size_t expected_size = sizeof(EntryHeader)
+                    + header.skeleton_words * sizeof(uint64_t)
+                    + header.vertex_pixels * sizeof(VertexPixel);
+            if (file->Size() != expected_size) {
+                throw std::runtime_error{"Invalid entry size"};
+            }
+
+            const uint8_t* skeleton_data = file->Data() + sizeof(EntryHeader);
+            const uint8_t* vertex_pixels_data = skeleton_data + header.skeleton_words * sizeof(uint64_t);
+
+            const PreprocessedGraph graph{
+                .rows = header.rows,
+                .columns = header.columns,
+                .inc_usage = header.inc_usage,
+                .skeleton_bits = {reinterpret_cast<const uint64_t*>(skeleton_data), header.skeleton_words},
+                .vertex_pixels = {reinterpret_cast<const VertexPixel*>(vertex_pixels_data), header.vertex_pixels}
+            };
+            CheckGraph(graph);
+
+            entry = CacheEntry{.file = std::move(file), .graph = graph};
+        } catch (const std::exception& e) {
+            LOG_WARNING << "Remove broken skeleton cache entry " << path << ": " << e.what();
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+            return std::nullopt;
+        }
+
+        // Modification time of entry is its last usage for eviction
+        std::error_code ec;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+
+        LOG_INFO << "Skeleton cache hit: " << key;
+
+        return entry;
+    }
+
+    void SkeletonCache::Store(const std::string& key, const OpticalGraphRecognition& ogr_algo) {
+        std::vector<uint64_t> skeleton_bits;
+        std::vector<VertexPixel> vertex_pixels;
+        const PreprocessedGraph graph = ogr_algo.GetPreprocessedGraph(skeleton_bits, vertex_pixels);
+
+        EntryHeader header{
+            .version = kFormatVersion,
+            .rows = graph.rows,
+            .columns = graph.columns,
+            .reserved = 0,
+            .inc_usage = graph.inc_usage,
+            .skeleton_words = graph.skeleton_bits.size(),
+            .vertex_pixels = graph.vertex_pixels.size()
+        };
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+
+        // Entry is written aside and renamed, so readers never see partially written one
+        const std::filesystem::path path = EntryPath(key);
+        std::filesystem::path tmp_path = path;
+        tmp_path += ".tmp" + std::to_string(::getpid()) + "-" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+        {
+            std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(graph.skeleton_bits.data()), graph.skeleton_bits.size_bytes());
+            out.write(reinterpret_cast<const char*>(graph.vertex_pixels.data()), graph.vertex_pixels.size_bytes());
+            out.flush();
+            if (!out) {
+                LOG_WARNING << "Failed to write skeleton cache entry " << tmp_path;
+                std::error_code ec;
+                std::filesystem::remove(tmp_path, ec);
+                return;
+            }
+        }
+
+        // Cache is only optimisation, so failed store doesn't fail image (temp entry isn't evicted, it is removed here)
+        std::error_code ec;
+        std::filesystem::rename(tmp_path, path, ec);
+        if (ec) {
+            LOG_WARNING << "Failed to store skeleton cache entry " << path << ": " << ec.message();
+            std::filesystem::remove(tmp_path, ec);
+            return;
+        }
+
+        LOG_INFO << "Skeleton cache store: " << key;
+
+        Evict();
+    }
+
+    std::filesystem::path SkeletonCache::EntryPath(const std::string& key) const {
+        return dir_ / (key + kEntryExtension);
+    }
+
+    void SkeletonCache::Evict() {
+        std::lock_guard lock(mutex_);
+
+        struct Entry {
+            std::filesystem::path path;
+            std::filesystem::file_time_type last_used;
+            uintmax_t size;
+        };
+
+        std::vector<Entry> entries;
+        uintmax_t total_size = 0;
+        std::error_code ec;
+        for (const auto& file : std::filesystem::directory_iterator{dir_, ec}) {
+            if (file.path().extension() != kEntryExtension) {
+                continue;
+            }
+
+            Entry entry{.path = file.path(), .last_used = file.last_write_time(ec), .size = file.file_size(ec)};
+            if (ec) {
+                continue;
+            }
+
+            total_size += entry.size;
+            entries.push_back(std::move(entry));
+        }
+
+        if (total_size <= max_size_bytes_) {
+            return;
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+            return lhs.last_used < rhs.last_used;
+        });
+
+        for (const Entry& entry : entries) {
+            if (total_size <= max_size_bytes_) {
+                break;
+            }
+
+            LOG_INFO << "Evict skeleton cache entry " << entry.path;
+            if (std::filesystem::remove(entry.path, ec)) {
+                total_size -= entry.size;
+            }
+        }
+    }
+}
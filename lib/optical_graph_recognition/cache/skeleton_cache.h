@@ -0,0 +1,53 @@
+#pragma once
+
+#include <optical_graph_recognition.h>
+#include <utils/mapped_file.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace ogr::cache {
+    /** Preprocessed graph of cache entry, it refers to entry mapping and is valid while entry is alive */
+    struct CacheEntry {
+        std::unique_ptr<utils::MappedFile> file;
+        PreprocessedGraph graph;
+    };
+
+    /**
+     * On-disk cache of preprocessed graphs (thinned skeleton and detected vertexes),
+     * so thinning and vertexes detection are skipped for unchanged images.
+     * Entries are keyed by hash of image bytes and preprocessing params, entry is compact binary file
+     * which is memory mapped on load. Recognition is restored from loaded entry by caller,
+     * so loading costs only mapping and validation. Total size of entries is bounded, least recently used ones are evicted.
+     */
+    class SkeletonCache {
+    public:
+        SkeletonCache(std::filesystem::path dir, uintmax_t max_size_bytes);
+
+        /** Preprocessing params should describe everything that affects skeleton and vertexes */
+        static std::string MakeKey(std::span<const uint8_t> image_bytes, std::string_view preprocessing_params);
+
+        /** Returns nullopt on miss, broken entries are removed */
+        std::optional<CacheEntry> Load(const std::string& key);
+
+        /** Recognition should be stored right after vertexes detection */
+        void Store(const std::string& key, const OpticalGraphRecognition& ogr_algo);
+
+    private:
+        std::filesystem::path EntryPath(const std::string& key) const;
+        void Evict();
+
+    private:
+        std::filesystem::path dir_;
+        uintmax_t max_size_bytes_;
+
+        // Eviction scans are serialized, entries themselves are replaced atomically by rename
+        std::mutex mutex_;
+    };
+}
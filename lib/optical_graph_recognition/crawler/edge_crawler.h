@@ -2,45 +2,60 @@
 
 #include <crawler/step_tree_node.h>
 #include <ogr_components/matrix.h>
+#include <ogr_components/mark_layer.h>
+#include <ogr_components/structured_elements.h>
 #include <iterators/neighbours.h>
 
 #include <vector>
 #include <memory>
+#include <optional>
 
 namespace ogr::crawler {
-    struct IEdgeCrawler;
-    using EdgeCrawlerPtr = std::shared_ptr<IEdgeCrawler>;
-
-    struct IEdgeCrawler {
-        virtual void Commit(StepPtr step) = 0;
-        virtual std::vector<StepPtr> NextSteps() = 0;
-        virtual bool CheckEdge(const double angle_diff_threshold) const = 0;
-        virtual bool IsComplete() const = 0;
-        virtual EdgePtr Materialize(VertexId source, EdgeId edge_id, matrix::Grm& grm) && = 0;
-        virtual StepTreeNodePtr GetCurrentStepTreeNode() const = 0;
-    };
-
-    struct Comparator {
-        bool operator()(const EdgeCrawlerPtr& crawler1, const EdgeCrawlerPtr& crawler2) {
-            return crawler1->GetCurrentStepTreeNode()->GetDiffAngleWithLastStep() > crawler2->GetCurrentStepTreeNode()->GetDiffAngleWithLastStep();
-        }
+    /** Shared state of all crawlers of single vertex */
+    template <size_t StepMaxSize>
+    struct CrawlerContext {
+        const AlgoParams& params;
+        const matrix::Grm& grm;
+        matrix::MarkLayer& marks;
+        StepsWalker& walker;
+        const SegmentGraph& segments;
+        StepsArena<StepMaxSize>& steps_arena;
     };
 
+    /**
+     * Crawler is a small value: position in step tree (path is shared through the tree) + cached priority key,
+     * so branching is a plain copy.
+     */
     template <size_t StepMaxSize, size_t SubPathStepsSize>
-    class EdgeCrawler : public IEdgeCrawler {
+    class EdgeCrawler {
+    public:
+        using Context = CrawlerContext<StepMaxSize>;
+
     public:
-        EdgeCrawler(matrix::Grm& grm, StepTreeNodePtr path_position);
+        EdgeCrawler(const Context& context, StepTreeNodePtr path_position);
+
     public:
-        void Commit(StepPtr step) override;
-        std::vector<StepPtr> NextSteps() override;
-        bool CheckEdge(const double angle_diff_threshold) const override;
-        bool IsComplete() const override;
-        EdgePtr Materialize(VertexId source, EdgeId edge_id, matrix::Grm& grm) && override;
-        StepTreeNodePtr GetCurrentStepTreeNode() const override;
+        void Commit(StepPtr step);
+        std::vector<StepPtr> NextSteps() const;
+        bool CheckEdge(const utils::BinaryAngle angle_diff_threshold) const;
+        bool IsComplete() const;
+        EdgePtr Materialize(VertexId source, EdgeId edge_id) const;
+        StepTreeNodePtr GetCurrentStepTreeNode() const;
+
+        // Diff angle with last step: crawlers with smaller one are processed first
+        utils::BinaryAngle GetPriorityKey() const;
 
     private:
-        matrix::Grm& grm_;
+        const Context* context_;
         StepTreeNodePtr path_position_;
+        utils::BinaryAngle priority_key_;
+    };
+
+    struct Comparator {
+        template <typename TEdgeCrawler>
+        bool operator()(const TEdgeCrawler& crawler1, const TEdgeCrawler& crawler2) const {
+            return crawler1.GetPriorityKey() > crawler2.GetPriorityKey();
+        }
     };
 
     //////////////////////////////////////////////////////////////////////
@@ -48,17 +63,27 @@ namespace ogr::crawler {
 
     template <size_t StepMaxSize, size_t SubPathStepsSize>
     inline EdgeCrawler<StepMaxSize, SubPathStepsSize>::EdgeCrawler(
-            matrix::Grm &grm,
+            const Context& context,
             StepTreeNodePtr path_position
-    ) : grm_(grm), path_position_(path_position) {
+    ) : context_(&context)
+      , path_position_(path_position)
+      , priority_key_(path_position->GetDiffAngleWithLastStep()) {
 
     }
 
     template <size_t StepMaxSize, size_t SubPathStepsSize>
-    inline std::vector<StepPtr> EdgeCrawler<StepMaxSize, SubPathStepsSize>::NextSteps() {
-        std::vector<point::FilledPointPtr> neighbours_vector = path_position_->GetStep()->GetUnmarkedNeighbours(grm_);
-        utils::StackVector<point::FilledPointPtr, StepMaxSize * 4> neighbours(neighbours_vector);
-        return MakeSteps<StepMaxSize>(neighbours, grm_);
+    inline std::vector<StepPtr> EdgeCrawler<StepMaxSize, SubPathStepsSize>::NextSteps() const {
+        // Inside skeleton segment next step is read from segment, neighbours are searched only at its ends
+        std::optional<std::vector<StepPtr>> segment_steps = MakeSegmentSteps<StepMaxSize>(
+                *path_position_->GetStep(), context_->segments, context_->marks, context_->steps_arena);
+        if (segment_steps.has_value()) {
+            return std::move(*segment_steps);
+        }
+
+        std::vector<point::Point> neighbours_vector = path_position_->GetStep()->GetUnmarkedNeighbours(
+                context_->grm, context_->marks);
+        utils::StackVector<point::Point, StepMaxSize * 4> neighbours(neighbours_vector);
+        return MakeSteps<StepMaxSize>(neighbours, context_->grm, context_->marks, context_->walker, context_->steps_arena);
     }
 
     template <size_t StepMaxSize, size_t SubPathStepsSize>
@@ -69,9 +94,9 @@ namespace ogr::crawler {
 
     template <size_t StepMaxSize, size_t SubPathStepsSize>
     inline void EdgeCrawler<StepMaxSize, SubPathStepsSize>::Commit(StepPtr step) {
-        StepTreeNodePtr next_node = path_position_->MakeChild(step);
-        point::DevMark(next_node->GetStep()->Back());
+        StepTreeNodePtr next_node = path_position_->MakeChild(step, context_->params);
         path_position_ = next_node;
+        priority_key_ = path_position_->GetDiffAngleWithLastStep();
     }
 
     template <size_t StepMaxSize, size_t SubPathStepsSize>
@@ -80,7 +105,12 @@ namespace ogr::crawler {
     }
 
     template <size_t StepMaxSize, size_t SubPathStepsSize>
-    inline bool EdgeCrawler<StepMaxSize, SubPathStepsSize>::CheckEdge(const double angle_diff_threshold) const {
+    inline utils::BinaryAngle EdgeCrawler<StepMaxSize, SubPathStepsSize>::GetPriorityKey() const {
+        return priority_key_;
+    }
+
+    template <size_t StepMaxSize, size_t SubPathStepsSize>
+    inline bool EdgeCrawler<StepMaxSize, SubPathStepsSize>::CheckEdge(const utils::BinaryAngle angle_diff_threshold) const {
         if (!path_position_->IsValid()) {
             return false;
         }
@@ -89,60 +119,45 @@ namespace ogr::crawler {
             return true;
         }
 
-        return fabs(path_position_->GetDiffAngleWithPrevState()) <= angle_diff_threshold;
+        return path_position_->GetDiffAngleWithPrevState() <= angle_diff_threshold;
     }
 
     template <size_t StepMaxSize, size_t SubPathStepsSize>
-    inline EdgePtr EdgeCrawler<StepMaxSize, SubPathStepsSize>::Materialize(VertexId source, EdgeId edge_id, matrix::Grm& grm) && {
+    inline EdgePtr EdgeCrawler<StepMaxSize, SubPathStepsSize>::Materialize(VertexId source, EdgeId edge_id) const {
         if (!path_position_->IsPort()) {
             throw std::runtime_error{"Last path position is not port: invalid materialize"};
         }
 
-        point::VertexPointPtr port_point;
-        for (point::PointPtr point : path_position_->GetStep()->GetPoints()) {
+        std::optional<point::Point> port_point;
+        for (const point::Point& point : path_position_->GetStep()->GetPoints()) {
             if (point::IsPortPoint(point)) {
-                port_point = std::dynamic_pointer_cast<point::VertexPoint>(point);
+                port_point = point;
             }
         }
 
-        if (!port_point) {
+        if (!port_point.has_value()) {
             throw std::runtime_error{"Port point not found"};
         }
 
-        VertexId destination = port_point->vertex.lock()->id;
+        VertexId destination = context_->grm.GetVertexId(*port_point);
         EdgePtr edge = std::make_shared<Edge>(edge_id, source, destination);
         StepTreeNodePtr current_path_node = path_position_;
 
         while (!current_path_node->IsRoot()) {
             StepPtr step = current_path_node->GetStep();
-            edge->irregularity = std::max(edge->irregularity, current_path_node->GetDiffAngleWithPrevStableState());
+            edge->irregularity = std::max(edge->irregularity, current_path_node->GetDiffAngleWithPrevStableState().ToDegrees());
 
             // Reverse points in step to support right points ordering
             auto step_points = step->GetPoints();
             std::reverse(step_points.begin(), step_points.end());
 
-            for (point::PointPtr step_point : step_points) {
-                // Attention! Point in grm can be different from point in step!
-                point::PointPtr point = grm[step_point->row][step_point->column];
+            for (const point::Point& point : step_points) {
                 if (point::IsPortPoint(point)) {
                     continue;
                 }
 
-                point::EdgePointPtr edge_point;
-                if (point::IsEdgePoint(point)) {
-                    edge_point = std::dynamic_pointer_cast<point::EdgePoint>(point);
-                } else {
-                    edge_point = std::make_shared<point::EdgePoint>(point->row, point->column);
-                    if (point::IsDevMarked(point)) {
-                        point::DevMark(edge_point);
-                    }
-
-                    grm[point->row][point->column] = edge_point;
-                }
-
-                edge_point->Mark();
-                edge_point->edges.push_back(edge);
-                edge->points.push_back(edge_point);
+                context_->marks.Mark(point);
+                edge->points.push_back(point);
             }
 
             current_path_node = current_path_node->GetParentNode();
@@ -7,7 +7,10 @@
 
 #include <plog/Log.h>
 
+#include <array>
 #include <queue>
+#include <string>
+#include <utility>
 
 namespace ogr::crawler {
     namespace {
@@ -22,79 +25,216 @@ namespace ogr::crawler {
 
             return result;
         }
-    }
 
-    std::vector<EdgePtr> FindEdges(const Vertex& source, matrix::Grm& grm, size_t& edge_id_counter) {
-        LOG_DEBUG << "Try to find edges from vertex: " << debug::DebugDump(source);
+        template <size_t kStepSize, size_t kSubPathStepsSize>
+        std::vector<EdgePtr> FindEdgesImpl(
+                const Vertex& source,
+                const matrix::Grm& grm,
+                matrix::MarkLayer& marks,
+                StepsWalker& walker,
+                const SegmentGraph& segments,
+                const AlgoParams& params,
+                const size_t beam_width,
+                size_t& pruned_crawlers
+        ) {
+            LOG_DEBUG << "Try to find edges from vertex: " << debug::DebugDump(source);
+
+            using StepTreeNodeImpl = StepTreeNode<kSubPathStepsSize>;
+            using EdgeCrawlerImpl = EdgeCrawler<kStepSize, kSubPathStepsSize>;
+
+            std::vector<EdgePtr> edges;
+
+            // All steps and step tree nodes of vertex are released at once on return
+            StepsArena<kStepSize> steps_arena;
+            typename StepTreeNodeImpl::Arena nodes_arena;
+            const typename EdgeCrawlerImpl::Context context{
+                    .params = params,
+                    .grm = grm,
+                    .marks = marks,
+                    .walker = walker,
+                    .segments = segments,
+                    .steps_arena = steps_arena
+            };
+
+            utils::StackVector<point::Point, 64> port_points;
+            for (const point::Point& port_point : source.port_points) {
+                port_points.PushBack(port_point);
+            }
 
-        // Configurable parameters
-        constexpr size_t kSubPathStepsSize = 7;
-        constexpr size_t kStepSize = 10;
+            std::vector<EdgeCrawlerImpl> initial_crawlers;
+            StepTreeNodePtr paths_tree = StepTreeNodeImpl::MakeRoot(nodes_arena);
+            auto initial_steps = MakeSteps<kStepSize>(port_points, grm, marks, walker, steps_arena);
 
-        using StepTreeNodeImpl = StepTreeNode<kSubPathStepsSize>;
-        using EdgeCrawlerImpl = EdgeCrawler<kStepSize, kSubPathStepsSize>;
 
-        std::vector<EdgePtr> edges;
+            for (StepPtr step : initial_steps) {
+                // Step consists only of 1 port point
+                if (!step->IsExhausted()) {
+                    continue;
+                }
 
-        utils::StackVector<point::FilledPointPtr, 64> port_points;
-        for (auto port_point : source.port_points) {
-            port_points.PushBack(port_point.lock());
-        }
+                LOG_DEBUG << "Add crawler with initial step: " << debug::DebugDump(*step);
 
-        std::priority_queue<EdgeCrawlerPtr, std::vector<EdgeCrawlerPtr>, crawler::Comparator> crawlers;
-        StepTreeNodePtr paths_tree = StepTreeNodeImpl::MakeRoot();
-        auto initial_steps = MakeSteps<kStepSize>(port_points, grm);
+                StepTreeNodePtr next_path_node = paths_tree->MakeChild(step, params);
+                initial_crawlers.emplace_back(context, next_path_node);
+            }
+
+            // Makes child crawlers for next steps of crawler: completed ones are materialized, valid ones are pushed
+            auto expand = [&](const EdgeCrawlerImpl& crawler, auto&& push) {
+                debug::DebugDump(grm, source.id);
+
+                LOG_DEBUG << "Run crawler: " << debug::DebugDump(*crawler.GetCurrentStepTreeNode());
+
+                // Prepare next steps
+                auto steps = FilterSteps(crawler.NextSteps());
+                if (steps.empty()) {
+                    LOG_DEBUG << "Next steps empty, skip crawler: " << debug::DebugDump(*crawler.GetCurrentStepTreeNode());
+                    return;
+                }
 
+                // Add crawlers for other steps
+                for (StepPtr step : steps) {
+                    EdgeCrawlerImpl next_crawler = crawler;
+                    next_crawler.Commit(step);
+
+                    if (next_crawler.IsComplete()) {
+                        LOG_DEBUG << "Materialize edge for crawler: " << debug::DebugDump(*next_crawler.GetCurrentStepTreeNode());
+                        edges.push_back(next_crawler.Materialize(source.id, edges.size()));
+                        continue;
+                    }
+
+                    if (next_crawler.CheckEdge(params.angle_diff_threshold)) {
+                        push(next_crawler);
+                        continue;
+                    }
+
+                    LOG_DEBUG << "Skip crawler: " << debug::DebugDump(*next_crawler.GetCurrentStepTreeNode());
+                }
+            };
+
+            if (!beam_width) {
+                // Exhaustive best first search
+                std::priority_queue<EdgeCrawlerImpl, std::vector<EdgeCrawlerImpl>, crawler::Comparator> crawlers;
+                for (const EdgeCrawlerImpl& crawler : initial_crawlers) {
+                    crawlers.push(crawler);
+                }
+
+                while (!crawlers.empty()) {
+                    const EdgeCrawlerImpl crawler = crawlers.top();
+                    crawlers.pop();
+
+                    expand(crawler, [&](const EdgeCrawlerImpl& next_crawler) {
+                        crawlers.push(next_crawler);
+                    });
+                }
 
-        for (StepPtr step : initial_steps) {
-            // Step consists only of 1 port point
-            if (!step->IsExhausted()) {
-                continue;
+                return edges;
             }
 
-            LOG_DEBUG << "Add crawler with initial step: " << debug::DebugDump(*step);
+            // Beam search: crawlers of the same depth are expanded from best to worst, worst ones are pruned
+            std::vector<EdgeCrawlerImpl> beam = std::move(initial_crawlers);
+            while (!beam.empty()) {
+                std::stable_sort(beam.begin(), beam.end(), [](const EdgeCrawlerImpl& lhs, const EdgeCrawlerImpl& rhs) {
+                    return crawler::Comparator{}(rhs, lhs);
+                });
+
+                if (beam.size() > beam_width) {
+                    LOG_DEBUG << "Prune " << beam.size() - beam_width << " crawlers";
+                    pruned_crawlers += beam.size() - beam_width;
+                    beam.erase(beam.begin() + beam_width, beam.end());
+                }
+
+                std::vector<EdgeCrawlerImpl> next_beam;
+                for (const EdgeCrawlerImpl& crawler : beam) {
+                    expand(crawler, [&](const EdgeCrawlerImpl& next_crawler) {
+                        next_beam.push_back(next_crawler);
+                    });
+                }
+
+                beam = std::move(next_beam);
+            }
 
-            StepTreeNodePtr next_path_node = paths_tree->MakeChild(step);
-            point::DevMark(next_path_node->GetStep()->Back());
-            crawlers.push(std::make_shared<EdgeCrawlerImpl>(grm, next_path_node));
+            return edges;
         }
 
-        while (!crawlers.empty()) {
-            debug::DebugDump(grm, source.id);
+        using FindEdgesFunc = std::vector<EdgePtr> (*)(
+                const Vertex&, const matrix::Grm&, matrix::MarkLayer&, StepsWalker&, const SegmentGraph&, const AlgoParams&, size_t, size_t&);
+
+        struct FindEdgesInstantiation {
+            CrawlerSizes sizes;
+            FindEdgesFunc find_edges;
+        };
+
+        // Sizes are template params of crawler (steps are stored on stack), so every pair of grid is precompiled
+        constexpr std::array<size_t, 5> kStepSizes{6, 8, 10, 12, 16};
+        constexpr std::array<size_t, 3> kSubPathStepsSizes{5, 7, 9};
+
+        template <size_t... Indexes>
+        constexpr auto MakeFindEdgesInstantiations(std::index_sequence<Indexes...>) {
+            constexpr size_t kColumns = kSubPathStepsSizes.size();
+            return std::array<FindEdgesInstantiation, sizeof...(Indexes)>{
+                FindEdgesInstantiation{
+                    .sizes = {
+                        .step_size = kStepSizes[Indexes / kColumns],
+                        .sub_path_steps_size = kSubPathStepsSizes[Indexes % kColumns]
+                    },
+                    .find_edges = &FindEdgesImpl<kStepSizes[Indexes / kColumns], kSubPathStepsSizes[Indexes % kColumns]>
+                }...
+            };
+        }
+
+        constexpr auto kFindEdgesInstantiations = MakeFindEdgesInstantiations(
+                std::make_index_sequence<kStepSizes.size() * kSubPathStepsSizes.size()>{});
+    }
+
+    std::vector<CrawlerSizes> SupportedCrawlerSizes() {
+        std::vector<CrawlerSizes> result;
+        for (const FindEdgesInstantiation& instantiation : kFindEdgesInstantiations) {
+            result.push_back(instantiation.sizes);
+        }
 
-            EdgeCrawlerPtr crawler = crawlers.top();
-            crawlers.pop();
+        return result;
+    }
 
-            LOG_DEBUG << "Run crawler: " << debug::DebugDump(*crawler);
+    std::vector<EdgePtr> FindEdges(
+            const Vertex& source,
+            const matrix::Grm& grm,
+            matrix::MarkLayer& marks,
+            StepsWalker& walker,
+            const SegmentGraph& segments,
+            const AlgoParams& params,
+            const CrawlerSizes& sizes,
+            const size_t beam_width,
+            size_t& pruned_crawlers
+    ) {
+        if (segments.StepSize() != sizes.step_size) {
+            throw std::runtime_error{"Segment graph is built for other step size"};
+        }
 
-            // Prepare next steps
-            auto steps = FilterSteps(crawler->NextSteps());
-            if (steps.empty()) {
-                LOG_DEBUG << "Next steps empty, skip crawler: " << debug::DebugDump(*crawler);
-                continue;
+        for (const FindEdgesInstantiation& instantiation : kFindEdgesInstantiations) {
+            if (instantiation.sizes.step_size == sizes.step_size
+                && instantiation.sizes.sub_path_steps_size == sizes.sub_path_steps_size) {
+                return instantiation.find_edges(source, grm, marks, walker, segments, params, beam_width, pruned_crawlers);
             }
+        }
 
-            // Add crawlers for other steps
-            for (StepPtr step : steps) {
-                auto next_crawler = std::make_shared<EdgeCrawlerImpl>(dynamic_cast<EdgeCrawlerImpl&>(*crawler));
-                next_crawler->Commit(step);
+        throw std::runtime_error{
+            "Crawler with step size " + std::to_string(sizes.step_size) +
+            " and sub path steps size " + std::to_string(sizes.sub_path_steps_size) + " is not precompiled"};
+    }
 
-                if (next_crawler->IsComplete()) {
-                    LOG_DEBUG << "Materialize edge for crawler: " << debug::DebugDump(*next_crawler);
-                    EdgePtr new_edge = std::move(*next_crawler).Materialize(source.id, edge_id_counter++, grm);
-                    edges.push_back(new_edge);
-                    continue;
-                }
+    void CommitEdges(const std::vector<EdgePtr>& edges, const EdgeId first_edge_id, matrix::Grm& grm) {
+        for (size_t i = 0; i < edges.size(); ++i) {
+            const EdgePtr& edge = edges[i];
+            edge->id = first_edge_id + i;
+            grm.RegisterEdge(edge->id, edge->v1, edge->v2);
 
-                if (next_crawler->CheckEdge(kAngleDiffThreshold)) {
-                    crawlers.push(next_crawler);
-                    continue;
+            for (const point::Point& point : edge->points) {
+                if (!point::IsEdgePoint(point)) {
+                    grm.MakeEdgePoint(point);
                 }
 
-                LOG_DEBUG << "Skip crawler: " << debug::DebugDump(*next_crawler);
+                grm.GetEdges(point).Insert(edge->id);
             }
         }
-
-        return edges;
     }
 }
\ No newline at end of file
@@ -1,10 +1,43 @@
 #pragma once
 
+#include <algo_params/params.h>
 #include <ogr_components/matrix.h>
+#include <ogr_components/mark_layer.h>
 #include <ogr_components/structured_elements.h>
+#include <crawler/step.h>
+#include <crawler/segment_graph.h>
 
 #include <vector>
 
 namespace ogr::crawler {
-    std::vector<EdgePtr> FindEdges(const Vertex& source, matrix::Grm& grm, size_t& edge_id_counter);
+    /** Amount of points in crawler step and amount of steps in sub path averaged for state angle */
+    struct CrawlerSizes {
+        size_t step_size = 10;
+        size_t sub_path_steps_size = 7;
+    };
+
+    /** Sizes with precompiled crawlers, FindEdges accepts only them */
+    std::vector<CrawlerSizes> SupportedCrawlerSizes();
+
+    /**
+     * Finds edges from source vertex. Matrix is not modified: points are marked in marks layer,
+     * found edges are numbered from 0 and should be stored in matrix with CommitEdges.
+     * Walker should be created over the same marks layer and can be reused for next vertexes.
+     * Segment graph of matrix skeleton should be built for the same step size, it's shared by all vertexes.
+     * Non zero beam_width enables beam search: on every depth only beam_width best crawlers are expanded,
+     * amount of dropped crawlers is added to pruned_crawlers.
+     */
+    std::vector<EdgePtr> FindEdges(
+            const Vertex& source,
+            const matrix::Grm& grm,
+            matrix::MarkLayer& marks,
+            StepsWalker& walker,
+            const SegmentGraph& segments,
+            const AlgoParams& params,
+            const CrawlerSizes& sizes,
+            size_t beam_width,
+            size_t& pruned_crawlers);
+
+    /** Assigns ids to found edges starting from first_edge_id and makes their points edge points */
+    void CommitEdges(const std::vector<EdgePtr>& edges, EdgeId first_edge_id, matrix::Grm& grm);
 }
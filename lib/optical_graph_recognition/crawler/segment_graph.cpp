@@ -0,0 +1,149 @@
+#include "segment_graph.h"
+
+#include <iterators/neighbours.h>
+
+#include <plog/Log.h>
+
+#include <algorithm>
+#include <bit>
+
+namespace ogr::crawler {
+    PixelClass ClassifyPixel(const point::Point& point) {
+        if (point::IsVertexPoint(point)) {
+            return point::IsPortPoint(point) ? PixelClass::Port : PixelClass::Vertex;
+        }
+
+        const int neighbours = std::popcount(point.state->neighbours);
+        if (neighbours <= 1) {
+            return PixelClass::Endpoint;
+        }
+
+        return neighbours == 2 ? PixelClass::Regular : PixelClass::Junction;
+    }
+
+    SegmentGraph::SegmentGraph(const matrix::SkeletonIndex& skeleton, const matrix::Grm& grm, const size_t step_size)
+        : skeleton_(skeleton)
+        , step_size_(step_size)
+        , offsets_{0}
+        , positions_(skeleton.Size(), kNoPosition) {
+        if (step_size < 2) {
+            throw std::runtime_error{"Segment graph step size should be at least 2"};
+        }
+
+        iterator::Neighbourhood8 neighbourhood;
+        auto is_regular = [](const point::Point& point) {
+            return ClassifyPixel(point) == PixelClass::Regular;
+        };
+
+        // Every segment is walked from its first end met in row-major order: regular pixel next to non regular one
+        size_t rank = 0;
+        utils::ForAll(skeleton_, grm, [&](const point::Point& point) {
+            const size_t point_rank = rank++;
+            if (positions_[point_rank] != kNoPosition || !is_regular(point)) {
+                return;
+            }
+
+            std::optional<point::Point> terminal;
+            for (const point::Point& neighbour : neighbourhood(point, grm)) {
+                if (!is_regular(neighbour)) {
+                    terminal = neighbour;
+                    break;
+                }
+            }
+
+            if (!terminal.has_value()) {
+                return;
+            }
+
+            positions_[point_rank] = static_cast<uint32_t>(points_.size());
+            points_.push_back(point);
+
+            point::Point prev = *terminal;
+            point::Point current = point;
+            while (true) {
+                // Regular pixel has exactly two neighbours: the one we came from and the next one
+                const auto neighbours = neighbourhood(current, grm);
+                const point::Point next = neighbours[0] == prev ? neighbours[1] : neighbours[0];
+                if (!is_regular(next)) {
+                    terminals_.push_back({*terminal, next});
+                    break;
+                }
+
+                positions_[*skeleton_.Find(next.row, next.column)] = static_cast<uint32_t>(points_.size());
+                points_.push_back(next);
+                prev = current;
+                current = next;
+            }
+
+            offsets_.push_back(static_cast<uint32_t>(points_.size()));
+        });
+
+        auto direction_angle = [](const point::Point& from, const point::Point& to) {
+            return utils::ComputeDirectionAngle(
+                    static_cast<int>(to.column) - static_cast<int>(from.column),
+                    static_cast<int>(to.row) - static_cast<int>(from.row));
+        };
+
+        const uint32_t radius = static_cast<uint32_t>(step_size_ - 1);
+        forward_samples_.resize(points_.size());
+        backward_samples_.resize(points_.size());
+        for (uint32_t segment = 0; segment < SegmentsCount(); ++segment) {
+            for (uint32_t position = Begin(segment); position < End(segment); ++position) {
+                if (position + radius < End(segment)) {
+                    forward_samples_[position] = direction_angle(points_[position], points_[position + radius]);
+                }
+                if (position >= Begin(segment) + radius) {
+                    backward_samples_[position] = direction_angle(points_[position], points_[position - radius]);
+                }
+            }
+        }
+
+        LOG_INFO << "Skeleton segment graph is built: " << SegmentsCount() << " segments of " << points_.size() << " regular points";
+    }
+
+    std::optional<SegmentRun> SegmentGraph::FindRun(const std::span<const point::Point> points) const {
+        if (points.size() < 2) {
+            return std::nullopt;
+        }
+
+        const point::Point& back = points.back();
+        const std::optional<size_t> rank = skeleton_.Find(back.row, back.column);
+        if (!rank.has_value() || positions_[*rank] == kNoPosition) {
+            return std::nullopt;
+        }
+
+        const uint32_t last = positions_[*rank];
+        const uint32_t segment = static_cast<uint32_t>(std::upper_bound(offsets_.begin(), offsets_.end(), last) - offsets_.begin() - 1);
+        const int64_t begin = Begin(segment);
+        const int64_t end = End(segment);
+
+        // Direction of run is defined by previous point
+        const point::Point& prev = points[points.size() - 2];
+        int32_t direction = 0;
+        if (last > begin && points_[last - 1] == prev) {
+            direction = 1;
+        } else if (last + 1 < end && points_[last + 1] == prev) {
+            direction = -1;
+        } else {
+            return std::nullopt;
+        }
+
+        const int64_t first = last - direction * static_cast<int64_t>(points.size() - 1);
+        if (first < begin || first >= end) {
+            return std::nullopt;
+        }
+
+        for (size_t i = 0; i < points.size(); ++i) {
+            if (!(points_[first + direction * static_cast<int64_t>(i)] == points[i])) {
+                return std::nullopt;
+            }
+        }
+
+        return SegmentRun{
+            .segment = segment,
+            .first = static_cast<uint32_t>(first),
+            .last = last,
+            .direction = direction
+        };
+    }
+}
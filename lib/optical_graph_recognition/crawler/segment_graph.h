@@ -0,0 +1,96 @@
+#pragma once
+
+#include <ogr_components/matrix.h>
+#include <ogr_components/point.h>
+#include <ogr_components/skeleton_index.h>
+#include <utils/geometry.h>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace ogr::crawler {
+    /** Static role of skeleton pixel, regular pixels have exactly two neighbours and form unbranched runs */
+    enum class PixelClass : uint8_t {
+        Endpoint,
+        Regular,
+        Junction,
+        Port,
+        Vertex
+    };
+
+    PixelClass ClassifyPixel(const point::Point& point);
+
+    /** Consecutive points [first, last] of segment, last = first + direction * (size - 1) */
+    struct SegmentRun {
+        uint32_t segment;
+        uint32_t first;
+        uint32_t last;
+        int32_t direction;
+    };
+
+    /**
+     * Skeleton collapsed to segments: maximal runs of regular pixels between junctions, endpoints and vertexes.
+     * Segment stores its pixel run (runs of all segments are kept in one array), terminal pixels next to run ends
+     * and direction samples of steps of step size starting at every run pixel in both directions.
+     * Marks only remove neighbours, so segments stay valid while edges are crawled.
+     * Rings of regular pixels without junctions aren't collected: they can't be reached from vertexes.
+     */
+    class SegmentGraph {
+    public:
+        SegmentGraph(const matrix::SkeletonIndex& skeleton, const matrix::Grm& grm, size_t step_size);
+
+        /** Run of segment consisting of given consecutive points, nullopt if points aren't inside single segment */
+        std::optional<SegmentRun> FindRun(std::span<const point::Point> points) const;
+
+        size_t StepSize() const {
+            return step_size_;
+        }
+
+        size_t SegmentsCount() const {
+            return terminals_.size();
+        }
+
+        uint32_t Begin(const uint32_t segment) const {
+            return offsets_[segment];
+        }
+
+        uint32_t End(const uint32_t segment) const {
+            return offsets_[segment + 1];
+        }
+
+        const point::Point& At(const uint32_t position) const {
+            return points_[position];
+        }
+
+        /** Pixel out of segment next to its run end: before Begin for -1 direction and after End - 1 for +1 one */
+        const point::Point& Terminal(const uint32_t segment, const int32_t direction) const {
+            return terminals_[segment][direction > 0];
+        }
+
+        /** Direction angle of step from position to position + direction * (step size - 1), step should fit into segment */
+        utils::BinaryAngle DirectionSample(const uint32_t position, const int32_t direction) const {
+            return direction > 0 ? forward_samples_[position] : backward_samples_[position];
+        }
+
+    private:
+        static constexpr uint32_t kNoPosition = std::numeric_limits<uint32_t>::max();
+
+        const matrix::SkeletonIndex& skeleton_;
+        size_t step_size_;
+
+        // Runs of all segments: segment s occupies [offsets_[s], offsets_[s + 1])
+        std::vector<point::Point> points_;
+        std::vector<uint32_t> offsets_;
+        std::vector<std::array<point::Point, 2>> terminals_;
+
+        // Position in runs of every skeleton point (by rank), kNoPosition for non regular points
+        std::vector<uint32_t> positions_;
+
+        std::vector<utils::BinaryAngle> forward_samples_;
+        std::vector<utils::BinaryAngle> backward_samples_;
+    };
+}
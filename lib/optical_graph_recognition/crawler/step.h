@@ -2,35 +2,42 @@
 
 #include <ogr_components/point.h>
 #include <ogr_components/matrix.h>
+#include <ogr_components/mark_layer.h>
+#include <crawler/segment_graph.h>
 #include <iterators/consecutive_iterator.h>
 #include <iterators/neighbours.h>
 #include <utils/geometry.h>
 #include <utils/stack_vector.h>
 #include <utils/debug.h>
+#include <utils/arena.h>
 
 #include <plog/Log.h>
 
 #include <array>
 #include <memory>
+#include <optional>
 #include <vector>
 #include <exception>
 #include <set>
 
 namespace ogr::crawler {
     struct IStep;
-    using StepPtr = std::shared_ptr<IStep>;
+
+    // Steps are owned by arena of edges detection for single vertex
+    using StepPtr = IStep*;
 
     /** General interface for steps of all sizes */
     struct IStep {
-        virtual void Push(point::FilledPointPtr point) = 0;
-        virtual double GetDirectionAngle() const = 0;
+        virtual void Push(const point::Point& point) = 0;
+        virtual utils::BinaryAngle GetDirectionAngle() const = 0;
         virtual bool IsExhausted() const = 0;
         virtual size_t Size() const  = 0;
         virtual bool IsPort() const = 0;
-        virtual point::FilledPointPtr Back() const = 0;
-        virtual point::FilledPointPtr Front() const = 0;
-        virtual std::vector<point::FilledPointPtr> GetUnmarkedNeighbours(const matrix::Grm& grm) = 0;
-        virtual std::vector<point::FilledPointPtr> GetPoints() const = 0;
+        virtual point::Point Back() const = 0;
+        virtual point::Point Front() const = 0;
+        virtual std::vector<point::Point> GetUnmarkedNeighbours(const matrix::Grm& grm, const matrix::MarkLayer& marks) = 0;
+        virtual std::vector<point::Point> GetPoints() const = 0;
+        virtual const std::optional<SegmentRun>& GetSegmentRun() const = 0;
 
         virtual ~IStep() = default;
     };
@@ -38,7 +45,7 @@ namespace ogr::crawler {
     template <size_t MaxSize>
     class Step final : public IStep {
     public:
-        void Push(point::FilledPointPtr point) override {
+        void Push(const point::Point& point) override {
             if (point::IsPortPoint(point)) {
                 is_port_ = true;
             }
@@ -46,27 +53,17 @@ namespace ogr::crawler {
             points_.PushBack(point);
         }
 
-        double GetDirectionAngle() const override {
+        utils::BinaryAngle GetDirectionAngle() const override {
             if (Size() <= 1) {
                 throw std::runtime_error{"Try to get direction angle from step consists of points less than 2"};
             }
 
-            point::PointPtr p1 = points_.Back();
-            point::PointPtr p2 = points_.Front();
-            utils::PlanarVector v1 = *p1 - *p2;
-            v1.Normalize();
-            const double alpha1 = utils::Rad2Deg(v1.GetAngle());
-            if (Size() == 2) {
-                return alpha1;
+            if (direction_angle_.has_value()) {
+                return *direction_angle_;
             }
 
-            point::PointPtr p3 = points_[Size() - 2];
-            utils::PlanarVector v2 = *p1 - *p2;
-            v2.Normalize();
-            double alpha2 = utils::Rad2Deg(v2.GetAngle());
-            alpha2 = utils::AlignAngle(alpha2, alpha1);
-
-            return utils::NormalizeAngle((alpha1 + alpha2) / 2);
+            // Points of step are consecutive, so step fits into box of MaxSize - 1 radius
+            return point::DirectionAngle<MaxSize - 1>(points_.Front(), points_.Back());
         }
 
         bool IsExhausted() const override {
@@ -81,70 +78,142 @@ namespace ogr::crawler {
             return is_port_;
         }
 
-        point::FilledPointPtr Back() const override {
+        point::Point Back() const override {
             return points_.Back();
         }
 
-        point::FilledPointPtr Front() const override {
+        point::Point Front() const override {
             return points_.Front();
         }
 
-        std::vector<point::FilledPointPtr> GetUnmarkedNeighbours(const matrix::Grm& grm) override {
-            std::set<point::Point*> used;
-            std::vector<point::FilledPointPtr> result;
+        std::vector<point::Point> GetUnmarkedNeighbours(const matrix::Grm& grm, const matrix::MarkLayer& marks) override {
+            std::set<const point::PointState*> used;
+            std::vector<point::Point> result;
 
             for (const auto& point : points_) {
                 auto neighbours = neighbourhood_(point, grm);
-                neighbours = iterator::filter::FilterMarkedPoints(neighbours);
-                for (point::PointPtr& neighbour : neighbours) {
-                    if (used.contains(neighbour.get())) {
+                neighbours = iterator::filter::FilterMarkedPoints(neighbours, marks);
+                for (const point::Point& neighbour : neighbours) {
+                    if (used.contains(neighbour.state)) {
                         continue;
                     }
-                    used.insert(neighbour.get());
-                    result.push_back(std::dynamic_pointer_cast<point::FilledPoint>(neighbour));
+                    used.insert(neighbour.state);
+                    result.push_back(neighbour);
                 }
             }
 
             return result;
         }
 
-        std::vector<point::FilledPointPtr> GetPoints() const override {
-            std::vector<point::FilledPointPtr> result;
-            for (point::FilledPointPtr point : points_) {
+        std::vector<point::Point> GetPoints() const override {
+            std::vector<point::Point> result;
+            for (const point::Point& point : points_) {
                 result.push_back(point);
             }
 
             return result;
         }
 
+        const std::optional<SegmentRun>& GetSegmentRun() const override {
+            return segment_run_;
+        }
+
+        /** Step is read from segment: its run and direction sample (for exhausted step) are known beforehand */
+        void SetSegmentRun(const SegmentRun& run, const std::optional<utils::BinaryAngle> direction_angle) {
+            segment_run_ = run;
+            direction_angle_ = direction_angle;
+        }
+
     private:
-        utils::StackVector<point::FilledPointPtr, MaxSize> points_;
+        utils::StackVector<point::Point, MaxSize> points_;
         iterator::Neighbourhood8 neighbourhood_;
 
         // Contains at least one port point
         bool is_port_{false};
+
+        std::optional<SegmentRun> segment_run_;
+        std::optional<utils::BinaryAngle> direction_angle_;
     };
 
     template <size_t StepSize>
-    std::vector<StepPtr> MakeSteps(point::FilledPointPtr point, const matrix::Grm& grm) {
-        LOG_DEBUG << "Make steps from point: " << debug::DebugDump(*point);
+    using StepsArena = utils::Arena<Step<StepSize>>;
 
-        using NeighbourhoodStrategy = iterator::Neighbourhood8;
-        NeighbourhoodStrategy neighbourhood;
+    // Walker of steps making, single one is reused by all steps of worker
+    using StepsWalker = iterator::ConsecutivePointsIterator<iterator::Neighbourhood8>;
+
+    /**
+     * Fast path of steps making for unbranched skeleton runs.
+     * If every point of step (except the last one) has at most one unmarked neighbour, consecutive points iterator
+     * would just walk along the run and never switch to other path, so the run is taken directly.
+     * Returns nullptr (nothing is marked) if run branches and general iterator is required.
+     */
+    template <size_t StepSize>
+    StepPtr MakeRunStep(
+            const point::Point& point,
+            const matrix::Grm& grm,
+            matrix::MarkLayer& marks,
+            StepsArena<StepSize>& arena
+    ) {
+        iterator::Neighbourhood8 neighbourhood;
+        utils::StackVector<point::Point, StepSize> run;
+        run.PushBack(point);
+
+        while (run.Size() < StepSize) {
+            std::optional<point::Point> next_point;
+            for (const point::Point& neighbour : neighbourhood(run.Back(), grm)) {
+                if (marks.IsMarked(neighbour) || run.Contains(neighbour)) {
+                    continue;
+                }
+
+                if (next_point.has_value()) {
+                    return nullptr;
+                }
+                next_point = neighbour;
+            }
 
-        if (point->IsMarked()) {
+            if (!next_point.has_value()) {
+                break;
+            }
+            run.PushBack(*next_point);
+        }
+
+        StepPtr step = &arena[arena.Make()];
+        for (const point::Point& run_point : run) {
+            marks.Mark(run_point);
+            step->Push(run_point);
+        }
+
+        LOG_DEBUG << "Run step is built: " << debug::DebugDump(*step);
+        return step;
+    }
+
+    template <size_t StepSize>
+    std::vector<StepPtr> MakeSteps(
+            const point::Point& point,
+            const matrix::Grm& grm,
+            matrix::MarkLayer& marks,
+            StepsWalker& walker,
+            StepsArena<StepSize>& arena
+    ) {
+        LOG_DEBUG << "Make steps from point: " << debug::DebugDump(point);
+
+        if (marks.IsMarked(point)) {
             throw std::runtime_error{"Point is already marked"};
         }
 
-        iterator::ConsecutivePointsIterator<NeighbourhoodStrategy> walker(grm, point);
+        if (StepPtr run_step = MakeRunStep<StepSize>(point, grm, marks, arena)) {
+            return {run_step};
+        }
+
+        walker.Reset(point);
         auto next_step = [&]() -> StepPtr {
             LOG_DEBUG << "Building new step";
-            StepPtr next_step = std::make_shared<Step<StepSize>>();
+            StepPtr next_step = &arena[arena.Make()];
             while (auto next_iteration = walker.Next()) {
-                point::FilledPointPtr point = std::dynamic_pointer_cast<point::FilledPoint>(*next_iteration);
-                point->Mark();
+                const point::Point point = *next_iteration;
+                marks.Mark(point);
 
-                LOG_DEBUG << "Add to step point: " << debug::DebugDump(*point);
+                LOG_DEBUG << "Add to step point: " << debug::DebugDump(point);
 
                 next_step->Push(point);
                 if (next_step->IsExhausted()) {
@@ -165,14 +234,111 @@ namespace ogr::crawler {
         }
     }
 
+    /**
+     * Next steps of step which lies inside skeleton segment, result is the same as of general steps making.
+     * Interior points of such step have only step points as neighbours, so if point before step is marked,
+     * the only candidate is next point of segment and next step is read from segment with mark checks only.
+     * Returns nullopt (nothing is marked) if step is not inside segment or it's unclear how next step leaves segment.
+     */
+    template <size_t StepSize>
+    std::optional<std::vector<StepPtr>> MakeSegmentSteps(
+            const IStep& step,
+            const SegmentGraph& segments,
+            matrix::MarkLayer& marks,
+            StepsArena<StepSize>& arena
+    ) {
+        std::optional<SegmentRun> run = step.GetSegmentRun();
+        if (!run.has_value()) {
+            run = segments.FindRun(step.GetPoints());
+        }
+
+        if (!run.has_value()) {
+            return std::nullopt;
+        }
+
+        const int64_t begin = segments.Begin(run->segment);
+        const int64_t end = segments.End(run->segment);
+        const int32_t direction = run->direction;
+
+        // Point of segment at position or terminal pixel if position is out of segment
+        auto point_at = [&](const int64_t position) -> const point::Point& {
+            if (position < begin) {
+                return segments.Terminal(run->segment, -1);
+            }
+            if (position >= end) {
+                return segments.Terminal(run->segment, 1);
+            }
+
+            return segments.At(static_cast<uint32_t>(position));
+        };
+
+        if (!marks.IsMarked(point_at(int64_t{run->first} - direction))) {
+            return std::nullopt;
+        }
+
+        const int64_t first = int64_t{run->last} + direction;
+        if (marks.IsMarked(point_at(first))) {
+            return std::vector<StepPtr>{};
+        }
+        if (first < begin || first >= end) {
+            return std::nullopt;
+        }
+
+        // Run of unmarked points, crossing into terminal pixel requires its neighbours search
+        int64_t last = first;
+        for (size_t size = 1; size < StepSize; ++size) {
+            const int64_t next = last + direction;
+            const bool is_inside = next >= begin && next < end;
+            if (marks.IsMarked(point_at(next))) {
+                break;
+            }
+            if (!is_inside) {
+                return std::nullopt;
+            }
+            last = next;
+        }
+
+        Step<StepSize>& next_step = arena[arena.Make()];
+        for (int64_t position = first;; position += direction) {
+            const point::Point& point = segments.At(static_cast<uint32_t>(position));
+            marks.Mark(point);
+            next_step.Push(point);
+            if (position == last) {
+                break;
+            }
+        }
+
+        std::optional<utils::BinaryAngle> direction_angle;
+        if (next_step.IsExhausted()) {
+            direction_angle = segments.DirectionSample(static_cast<uint32_t>(first), direction);
+        }
+        next_step.SetSegmentRun(
+                SegmentRun{
+                    .segment = run->segment,
+                    .first = static_cast<uint32_t>(first),
+                    .last = static_cast<uint32_t>(last),
+                    .direction = direction
+                },
+                direction_angle);
+
+        LOG_DEBUG << "Segment step is built: " << debug::DebugDump(next_step);
+        return std::vector<StepPtr>{&next_step};
+    }
+
     template <size_t StepSize, typename TStackVector>
-    std::vector<StepPtr> MakeSteps(TStackVector& points, const matrix::Grm& grm) {
+    std::vector<StepPtr> MakeSteps(
+            TStackVector& points,
+            const matrix::Grm& grm,
+            matrix::MarkLayer& marks,
+            StepsWalker& walker,
+            StepsArena<StepSize>& arena
+    ) {
         std::vector<StepPtr> result;
-        for (point::FilledPointPtr& point : points) {
-            if (point->IsMarked()) {
+        for (const point::Point& point : points) {
+            if (marks.IsMarked(point)) {
                 continue;
             }
-            std::vector<StepPtr> next_steps = MakeSteps<StepSize>(point, grm);
+            std::vector<StepPtr> next_steps = MakeSteps<StepSize>(point, grm, marks, walker, arena);
             for (StepPtr& step : next_steps) {
                 result.push_back(step);
             }
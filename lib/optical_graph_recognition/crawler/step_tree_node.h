@@ -2,28 +2,29 @@
 
 #include <algo_params/params.h>
 #include <crawler/step.h>
+#include <utils/arena.h>
 
-#include <memory>
 #include <vector>
 
 
 namespace ogr::crawler {
     struct IStepTreeNode;
-    using StepTreeNodePtr = std::shared_ptr<IStepTreeNode>;
-    using WeakStepTreeNodePtr = std::weak_ptr<IStepTreeNode>;
+
+    // Step tree nodes are owned by arena of edges detection for single vertex
+    using StepTreeNodePtr = IStepTreeNode*;
 
     struct IStepTreeNode {
-        virtual double GetLastStepAngle() const = 0;
-        virtual double GetStateAngle() const = 0;
-        virtual double GetDiffAngleWithPrevState() const = 0;
-        virtual double GetDiffAngleWithLastStep() const = 0;
-        virtual double GetDiffAngleWithPrevStableState() const = 0;
+        virtual utils::BinaryAngle GetLastStepAngle() const = 0;
+        virtual utils::BinaryAngle GetStateAngle() const = 0;
+        virtual utils::BinaryAngle GetDiffAngleWithPrevState() const = 0;
+        virtual utils::BinaryAngle GetDiffAngleWithLastStep() const = 0;
+        virtual utils::BinaryAngle GetDiffAngleWithPrevStableState() const = 0;
         virtual bool IsPort() const = 0;
         virtual bool IsRoot() const = 0;
         virtual StepPtr GetStep() const = 0;
         virtual size_t GetDepth() const = 0;
         virtual size_t GetStableDepth() const = 0;
-        virtual std::shared_ptr<IStepTreeNode> MakeChild(StepPtr step) = 0;
+        virtual StepTreeNodePtr MakeChild(StepPtr step, const AlgoParams& params) = 0;
         virtual StepTreeNodePtr GetParentNode() const = 0;
         virtual bool IsStable() const = 0;
         virtual bool IsValid() const = 0;
@@ -31,28 +32,35 @@ namespace ogr::crawler {
         virtual ~IStepTreeNode() = default;
 
     private:
-        virtual void CommitStableState() = 0;
+        virtual void CommitStableState(const AlgoParams& params) = 0;
     };
 
     template <size_t SubPathStepsSize>
-    class StepTreeNode : public std::enable_shared_from_this<StepTreeNode<SubPathStepsSize>>, public IStepTreeNode {
+    class StepTreeNode : public IStepTreeNode {
+    public:
+        using Arena = utils::Arena<StepTreeNode>;
+        using NodeIndex = typename Arena::Index;
+
     public:
-        StepTreeNode() = default;
-        explicit StepTreeNode(StepPtr step) : step_(step) {};
+        StepTreeNode(Arena& arena, NodeIndex index, StepPtr step = nullptr)
+            : arena_(&arena)
+            , index_(index)
+            , step_(step) {
+        }
 
     public:
-        static StepTreeNodePtr MakeRoot();
+        static StepTreeNodePtr MakeRoot(Arena& arena);
 
     public:
-        double GetLastStepAngle() const override;
-        double GetStateAngle() const override;
-        double GetDiffAngleWithPrevState() const override;
-        double GetDiffAngleWithLastStep() const override;
-        double GetDiffAngleWithPrevStableState() const override;
+        utils::BinaryAngle GetLastStepAngle() const override;
+        utils::BinaryAngle GetStateAngle() const override;
+        utils::BinaryAngle GetDiffAngleWithPrevState() const override;
+        utils::BinaryAngle GetDiffAngleWithLastStep() const override;
+        utils::BinaryAngle GetDiffAngleWithPrevStableState() const override;
         bool IsPort() const override;
         bool IsRoot() const override;
         StepPtr GetStep() const override;
-        StepTreeNodePtr MakeChild(StepPtr step) override;
+        StepTreeNodePtr MakeChild(StepPtr step, const AlgoParams& params) override;
         size_t GetDepth() const override;
         size_t GetStableDepth() const override;
         StepTreeNodePtr GetParentNode() const override;
@@ -60,24 +68,30 @@ namespace ogr::crawler {
         bool IsValid() const override;
 
     private:
-        void CommitStableState() override;
+        void CommitStableState(const AlgoParams& params) override;
+
+        StepTreeNode& Node(NodeIndex index) const {
+            return (*arena_)[index];
+        }
 
     private:
-        std::vector<StepTreeNodePtr> children_;
-        WeakStepTreeNodePtr parent_;
-        WeakStepTreeNodePtr stable_state_;
+        // Links to other nodes are indices in arena
+        Arena* arena_;
+        NodeIndex index_;
+        NodeIndex parent_{Arena::kNullIndex};
+        NodeIndex stable_state_{Arena::kNullIndex};
+        NodeIndex prev_state_{Arena::kNullIndex};
         StepPtr step_{nullptr};
-        WeakStepTreeNodePtr prev_state_;
-        double angle_{0};
+        utils::BinaryAngle angle_;
         size_t depth_{0};
         size_t stable_depth_{0};
         bool is_valid_{true};
     };
 
     template <size_t SubPathStepsSize>
-    inline StepTreeNodePtr StepTreeNode<SubPathStepsSize>::MakeRoot() {
-        StepTreeNodePtr root_node = std::make_shared<StepTreeNode>();
-        return root_node;
+    inline StepTreeNodePtr StepTreeNode<SubPathStepsSize>::MakeRoot(Arena& arena) {
+        const NodeIndex index = arena.Make(arena, static_cast<NodeIndex>(arena.Size()));
+        return &arena[index];
     }
 
     template <size_t SubPathStepsSize>
@@ -87,7 +101,7 @@ namespace ogr::crawler {
 
     template <size_t SubPathStepsSize>
     inline bool StepTreeNode<SubPathStepsSize>::IsRoot() const {
-        return !parent_.use_count();
+        return parent_ == Arena::kNullIndex;
     }
 
     template <size_t SubPathStepsSize>
@@ -101,14 +115,14 @@ namespace ogr::crawler {
     }
 
     template <size_t SubPathStepsSize>
-    inline double StepTreeNode<SubPathStepsSize>::GetStateAngle() const {
+    inline utils::BinaryAngle StepTreeNode<SubPathStepsSize>::GetStateAngle() const {
         return angle_;
     }
 
     template <size_t SubPathStepsSize>
-    inline double StepTreeNode<SubPathStepsSize>::GetLastStepAngle() const {
+    inline utils::BinaryAngle StepTreeNode<SubPathStepsSize>::GetLastStepAngle() const {
         if (IsRoot()) {
-            return 0;
+            return utils::BinaryAngle{};
         }
 
         return step_->GetDirectionAngle();
@@ -116,74 +130,79 @@ namespace ogr::crawler {
 
     template <size_t SubPathStepsSize>
     inline StepTreeNodePtr StepTreeNode<SubPathStepsSize>::GetParentNode() const {
-        return parent_.lock();
+        if (IsRoot()) {
+            return nullptr;
+        }
+
+        return &Node(parent_);
     }
 
     template <size_t SubPathStepsSize>
-    inline double StepTreeNode<SubPathStepsSize>::GetDiffAngleWithPrevState() const {
+    inline utils::BinaryAngle StepTreeNode<SubPathStepsSize>::GetDiffAngleWithPrevState() const {
         if (depth_ <= SubPathStepsSize) {
-            return 0;
+            return utils::BinaryAngle{};
         }
 
-        return utils::AbsDiffAngles(prev_state_.lock()->GetStateAngle(), angle_);
+        return utils::AbsDiffAngles(Node(prev_state_).GetStateAngle(), angle_);
     }
 
     template <size_t SubPathStepsSize>
-    inline double StepTreeNode<SubPathStepsSize>::GetDiffAngleWithLastStep() const {
+    inline utils::BinaryAngle StepTreeNode<SubPathStepsSize>::GetDiffAngleWithLastStep() const {
         if (depth_ < 2 || step_->IsPort()) {
-            return 0;
+            return utils::BinaryAngle{};
         }
 
-        return utils::AbsDiffAngles(parent_.lock()->GetStep()->GetDirectionAngle(), step_->GetDirectionAngle());
+        return utils::AbsDiffAngles(Node(parent_).GetStep()->GetDirectionAngle(), step_->GetDirectionAngle());
     }
 
     template <size_t SubPathStepsSize>
-    inline StepTreeNodePtr StepTreeNode<SubPathStepsSize>::MakeChild(StepPtr step) {
-        std::shared_ptr<StepTreeNode> step_node = std::make_shared<StepTreeNode>(step);
-        children_.push_back(step_node);
-        step_node->parent_ = this->shared_from_this();
+    inline StepTreeNodePtr StepTreeNode<SubPathStepsSize>::MakeChild(StepPtr step, const AlgoParams& params) {
+        const NodeIndex step_node_index = arena_->Make(*arena_, static_cast<NodeIndex>(arena_->Size()), step);
+        StepTreeNode* step_node = &Node(step_node_index);
+        step_node->parent_ = index_;
         step_node->depth_ = depth_ + 1;
 
         do {
             if (step_node->depth_ <= SubPathStepsSize) {
-                step_node->prev_state_ = IsRoot() ? this->shared_from_this() : prev_state_.lock();
+                step_node->prev_state_ = IsRoot() ? index_ : prev_state_;
                 if (IsRoot()) {
-                    step_node->angle_ = utils::NormalizeAngle(step->GetDirectionAngle());
+                    step_node->angle_ = step->GetDirectionAngle();
                     break;
                 }
 
-                const double step_angle = step->IsPort() ? angle_ : utils::AlignAngle(step->GetDirectionAngle(), angle_);
-                step_node->angle_ = utils::NormalizeAngle((angle_ * depth_ + step_angle) / (depth_ + 1));
+                // Running mean of steps angles: step angle is taken relative to current state angle
+                const int32_t step_angle_diff = step->IsPort() ? 0 : utils::SignedDiffAngles(step->GetDirectionAngle(), angle_);
+                step_node->angle_ = utils::RotateAngle(angle_, step_angle_diff / static_cast<int32_t>(depth_ + 1));
                 break;
             }
 
-            StepTreeNodePtr tree_node_ptr = this->shared_from_this();
+            NodeIndex prev_state_index = index_;
             for (size_t i = 0; i < SubPathStepsSize - 1; ++i) {
-                tree_node_ptr = tree_node_ptr->GetParentNode();
+                prev_state_index = Node(prev_state_index).parent_;
             }
-            step_node->prev_state_ = tree_node_ptr;
+            step_node->prev_state_ = prev_state_index;
+            const StepTreeNode* tree_node_ptr = &Node(prev_state_index);
 
             if (step->IsPort() && step->Size() == 1) {
-                step_node->angle_ = utils::NormalizeAngle(angle_);
+                step_node->angle_ = angle_;
                 return step_node;
             }
 
-            const double step_actual_angle = step->GetDirectionAngle();
-            const double aligned_step_angle = utils::AlignAngle(step_actual_angle, angle_);
-            const double last_step_angle = tree_node_ptr->GetLastStepAngle();
-            const double aligned_last_step_angle = utils::AlignAngle(last_step_angle, angle_);
-            step_node->angle_ = utils::NormalizeAngle(
-                    angle_ - (aligned_last_step_angle - aligned_step_angle) / SubPathStepsSize);
+            // Sliding mean of steps angles: the oldest step of sub path is replaced with the new one
+            const int32_t step_angle_diff = utils::SignedDiffAngles(step->GetDirectionAngle(), angle_);
+            const int32_t last_step_angle_diff = utils::SignedDiffAngles(tree_node_ptr->GetLastStepAngle(), angle_);
+            step_node->angle_ = utils::RotateAngle(
+                    angle_, (step_angle_diff - last_step_angle_diff) / static_cast<int32_t>(SubPathStepsSize));
         } while (false);
 
         step_node->stable_state_ = stable_state_;
         step_node->stable_depth_ = 1;
-        if (step_node->GetDiffAngleWithLastStep() <= kStableStateAngleDiffLocalThreshold) {
+        if (step_node->GetDiffAngleWithLastStep() <= params.stable_state_angle_diff_local_threshold) {
             step_node->stable_depth_ = stable_depth_ + 1;
             if (step_node->stable_depth_ == SubPathStepsSize) {
-                step_node->CommitStableState();
+                step_node->CommitStableState(params);
             } else if (step_node->stable_depth_ > SubPathStepsSize) {
-                step_node->stable_state_ = step_node;
+                step_node->stable_state_ = step_node_index;
             }
         }
 
@@ -191,43 +210,34 @@ namespace ogr::crawler {
     }
 
     template <size_t SubPathStepsSize>
-    inline double StepTreeNode<SubPathStepsSize>::GetDiffAngleWithPrevStableState() const {
-        if (!stable_state_.use_count()) {
-            return 0;
+    inline utils::BinaryAngle StepTreeNode<SubPathStepsSize>::GetDiffAngleWithPrevStableState() const {
+        if (stable_state_ == Arena::kNullIndex) {
+            return utils::BinaryAngle{};
         }
 
-        StepTreeNodePtr prev_stable_state = stable_state_.lock();
-        const double prev_stable_state_angle = prev_stable_state->GetStateAngle();
-        const double current_state_angle = GetStateAngle();
-        const double diff = utils::AbsDiffAngles(current_state_angle, prev_stable_state_angle);
-
-        return diff;
+        return utils::AbsDiffAngles(GetStateAngle(), Node(stable_state_).GetStateAngle());
     }
 
     template <size_t SubPathStepsSize>
-    inline void StepTreeNode<SubPathStepsSize>::CommitStableState() {
-        if (!stable_state_.use_count()) {
-            stable_state_ = this->shared_from_this();
+    inline void StepTreeNode<SubPathStepsSize>::CommitStableState(const AlgoParams& params) {
+        if (stable_state_ == Arena::kNullIndex) {
+            stable_state_ = index_;
             return;
         }
 
         // Check diff angles with previous stable state
         LOG_DEBUG << "Check validity: " << debug::DebugDump(*this);
-        if (GetDiffAngleWithPrevStableState() >= kStableStateAngleDiffThreshold) {
+        if (GetDiffAngleWithPrevStableState() >= params.stable_state_angle_diff_threshold) {
             is_valid_ = false;
             return;
         }
 
-        stable_state_ = this->shared_from_this();
+        stable_state_ = index_;
     }
 
     template <size_t SubPathStepsSize>
     inline bool StepTreeNode<SubPathStepsSize>::IsStable() const {
-        if (!stable_state_.use_count()) {
-            return false;
-        }
-
-        return stable_state_.lock().get() == this;
+        return stable_state_ == index_;
     }
 
     template <size_t SubPathStepsSize>
@@ -1,31 +1,66 @@
 #pragma once
 
 #include <ogr_components/matrix.h>
+#include <ogr_components/mark_layer.h>
 #include <iterators/neighbours.h>
 #include <utils/debug.h>
 
 #include <plog/Log.h>
 
-#include <queue>
-#include <optional>
-#include <utility>
-#include <unordered_set>
 #include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
 
 namespace ogr::iterator {
+    /**
+     * BFS walker over unmarked points which returns points consecutively (every point is neighbour of previous one),
+     * points breaking consecutiveness are postponed as other paths.
+     * Walker is reusable: Reset starts new walk, all buffers (and visited stamps of filled points count) are kept between walks,
+     * so walks of single worker allocate nothing in steady state.
+     */
     template <typename NeighboursStrategy>
     class ConsecutivePointsIterator {
-        using Path = std::vector<point::PointPtr>;
+        using NodeIndex = uint32_t;
+        static constexpr NodeIndex kNoParent = std::numeric_limits<NodeIndex>::max();
+
+        // Node of BFS tree: path to point is restored by parent links
+        struct Node {
+            point::Point point;
+            NodeIndex parent;
+        };
+
     public:
-        ConsecutivePointsIterator(const matrix::Grm &grm, point::PointPtr start_point) : grm_(grm) {
-            used_.insert(start_point.get());
-            bfs_queue_.push(std::make_pair(start_point, std::vector<point::PointPtr>{}));
+        ConsecutivePointsIterator(const matrix::Grm &grm, const matrix::MarkLayer& marks)
+            : grm_(grm)
+            , marks_(marks)
+            , visited_(grm.PointsCount()) {
+        }
+
+        ConsecutivePointsIterator(const ConsecutivePointsIterator&) = delete;
+        ConsecutivePointsIterator& operator=(const ConsecutivePointsIterator&) = delete;
+
+        /** Visited stamps memory per filled point */
+        static size_t PointBytes() {
+            return sizeof(uint32_t);
+        }
+
+        /** Start new walk from start point */
+        void Reset(const point::Point& start_point) {
+            nodes_.clear();
+            other_paths_.clear();
+            buffer_.clear();
+            prev_point_.reset();
+
+            RestartBfs(start_point);
+            Visit(start_point);
         }
 
         /**
          * Return next point in neighbourhood of previous returned point
          * */
-        std::optional<point::PointPtr> Next() {
+        std::optional<point::Point> Next() {
             while (true) {
                 if (!buffer_.empty()) {
                     auto point = buffer_.back();
@@ -34,37 +69,32 @@ namespace ogr::iterator {
                     return point;
                 }
 
-                if (bfs_queue_.empty()) {
+                if (queue_head_ == bfs_queue_.size()) {
                     return std::nullopt;
                 }
 
-                auto& queue_top = bfs_queue_.front();
-                const point::PointPtr point = queue_top.first;
-                std::vector<point::PointPtr> subpath = std::move(queue_top.second);
-                bfs_queue_.pop();
+                const NodeIndex node = bfs_queue_[queue_head_++];
+                const point::Point point = nodes_[node].point;
 
-                LOG_DEBUG << "Next iteration candidate " << debug::DebugDump(*point);
+                LOG_DEBUG << "Next iteration candidate " << debug::DebugDump(point);
 
                 const auto neighbours = neighbourhood_(point, grm_);
 
                 // Check that previous considered point is in neighbourhood of new point
-                if (prev_point_.get() != nullptr && !ContainsPoint(neighbours, prev_point_)) {
-                    other_paths_.emplace_back(std::make_pair(point, subpath));
+                if (prev_point_.has_value() && !ContainsPoint(neighbours, *prev_point_)) {
+                    other_paths_.push_back(node);
                     LOG_DEBUG << "Skip point";
                     continue;
                 }
 
-                subpath.push_back(point);
-
                 // Add unmarked neighbours to BFS queue
-                const auto unmarked_neighbours = filter::FilterMarkedPoints(neighbours);
-                for (const point::PointPtr& neighbour : unmarked_neighbours) {
-                    if (used_.contains(neighbour.get())) {
+                for (const point::Point& neighbour : neighbours) {
+                    if (marks_.IsMarked(neighbour) || IsVisited(neighbour)) {
                         continue;
                     }
-                    LOG_DEBUG << "Push to bfs queue point: " << debug::DebugDump(*neighbour);
-                    bfs_queue_.push(std::make_pair(neighbour, subpath));
-                    used_.insert(neighbour.get());
+                    LOG_DEBUG << "Push to bfs queue point: " << debug::DebugDump(neighbour);
+                    bfs_queue_.push_back(PushNode(neighbour, node));
+                    Visit(neighbour);
                 }
 
                 prev_point_ = point;
@@ -73,47 +103,84 @@ namespace ogr::iterator {
             }
         }
 
+        /**
+         * Continue walk from the last postponed point: path to it is returned first, then BFS restarts from it
+         * */
         bool ResetToOtherPath() {
             while (true) {
                 if (other_paths_.empty()) {
                     return false;
                 }
 
-                auto other_path = other_paths_.back();
-                point::PointPtr next_start_point = other_path.first;
-                Path subpath = std::move(other_path.second);
+                const Node other_path = nodes_[other_paths_.back()];
                 other_paths_.pop_back();
 
-                if (point::IsMarkedPoint(next_start_point)) {
+                if (marks_.IsMarked(other_path.point)) {
                     continue;
                 }
 
-                buffer_ = std::move(subpath);
-                std::reverse(buffer_.begin(), buffer_.end());
+                // Buffer is consumed from back, so path is stored from last point to first one
+                buffer_.clear();
+                for (NodeIndex node = other_path.parent; node != kNoParent; node = nodes_[node].parent) {
+                    buffer_.push_back(nodes_[node].point);
+                }
 
-                std::queue<std::pair<point::PointPtr, Path>> next_queue;
-                next_queue.push(std::make_pair(next_start_point, subpath));
-                bfs_queue_ = std::move(next_queue);
-                used_.clear();
+                // Nodes are kept: postponed paths refer to them
+                RestartBfs(other_path.point);
 
                 return true;
             }
         }
 
+    private:
+        NodeIndex PushNode(const point::Point& point, const NodeIndex parent) {
+            nodes_.push_back(Node{.point = point, .parent = parent});
+            return static_cast<NodeIndex>(nodes_.size() - 1);
+        }
+
+        void RestartBfs(const point::Point& start_point) {
+            bfs_queue_.clear();
+            queue_head_ = 0;
+            bfs_queue_.push_back(PushNode(start_point, kNoParent));
+
+            // Forget visited points by switching generation, stamps are wiped only on overflow
+            if (++generation_ == 0) {
+                std::fill(visited_.begin(), visited_.end(), 0);
+                generation_ = 1;
+            }
+        }
+
+        // Walk goes only through filled points, so they are identified by their rank
+        bool IsVisited(const point::Point& point) const {
+            return visited_[grm_.Rank(point)] == generation_;
+        }
+
+        void Visit(const point::Point& point) {
+            visited_[grm_.Rank(point)] = generation_;
+        }
+
     private:
         // Source grm matrix
         const matrix::Grm& grm_;
+        const matrix::MarkLayer& marks_;
+
+        // BFS tree of current walk
+        std::vector<Node> nodes_;
 
-        // Pair {path to this point, start point}
-        std::vector<std::pair<point::PointPtr, Path>> other_paths_;
+        // Nodes of postponed points
+        std::vector<NodeIndex> other_paths_;
 
         // Buffer of some points that should be iterated of firstly
-        Path buffer_;
+        std::vector<point::Point> buffer_;
 
         // Implementation details fields
-        point::PointPtr prev_point_{nullptr};
-        std::queue<std::pair<point::PointPtr, Path>> bfs_queue_;
+        std::optional<point::Point> prev_point_;
+        std::vector<NodeIndex> bfs_queue_;
+        size_t queue_head_{0};
         NeighboursStrategy neighbourhood_;
-        std::unordered_set<point::Point*> used_;
+
+        // Point is visited if its stamp equals current generation (zero stamp is never current)
+        std::vector<uint32_t> visited_;
+        uint32_t generation_{0};
     };
-}
\ No newline at end of file
+}
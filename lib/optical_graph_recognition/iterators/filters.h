@@ -2,13 +2,14 @@
 
 #include <utils/stack_vector.h>
 #include <ogr_components/point.h>
+#include <ogr_components/mark_layer.h>
 
 namespace ogr::iterator::filter {
     template<typename TStackVector>
-    TStackVector FilterMarkedPoints(const TStackVector &points) {
+    TStackVector FilterMarkedPoints(const TStackVector &points, const matrix::MarkLayer& marks) {
         TStackVector result;
-        for (const point::PointPtr& point : points) {
-            if (utils::As<point::FilledPoint>(point.get())->IsMarked()) {
+        for (const point::Point& point : points) {
+            if (marks.IsMarked(point)) {
                 continue;
             }
             result.PushBack(point);
@@ -20,8 +21,8 @@ namespace ogr::iterator::filter {
     template<typename TStackVector>
     TStackVector FilterEmptyPoints(const TStackVector &points) {
         TStackVector result;
-        for (const point::PointPtr& point : points) {
-            if (point->IsEmpty()) {
+        for (const point::Point& point : points) {
+            if (point.IsEmpty()) {
                 continue;
             }
             result.PushBack(point);
@@ -33,8 +34,8 @@ namespace ogr::iterator::filter {
     template <typename TStackVector>
     TStackVector FilterVertexPoints(const TStackVector& points) {
         TStackVector result;
-        for (const point::PointPtr& point : points) {
-            if (utils::Is<point::VertexPoint>(point.get())) {
+        for (const point::Point& point : points) {
+            if (point::IsVertexPoint(point)) {
                 continue;
             }
             result.PushBack(point);
@@ -42,4 +43,4 @@ namespace ogr::iterator::filter {
 
         return result;
     }
-}
\ No newline at end of file
+}
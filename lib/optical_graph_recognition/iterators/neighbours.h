@@ -1,29 +1,40 @@
 #pragma once
 
+#include <bit>
 #include <utility>
 #include <type_traits>
 
 #include <ogr_components/matrix.h>
 #include <utils/stack_vector.h>
-#include <utils/matrix_utils.h>
 #include <iterators/filters.h>
 
 namespace ogr::iterator {
     namespace detail {
-        template<class TStackVector>
-        TStackVector PreFilterNeighbours(const TStackVector &candidates, const size_t max_rows, const size_t max_cols) {
-            TStackVector result;
-            for (const auto &candidate: candidates) {
-                const int row = candidate.first;
-                const int column = candidate.second;
-                if (row < 0 || column < 0) {
+        template <size_t MaxSize>
+        inline utils::StackVector<point::Point, MaxSize> CollectNeighbours(
+                const point::Point& point,
+                const matrix::Grm& grm,
+                const std::array<size_t, MaxSize>& offsets_order
+        ) {
+            const int row = static_cast<int>(point.row);
+            const int column = static_cast<int>(point.column);
+
+            utils::StackVector<point::Point, MaxSize> result;
+
+            // Skeleton points store occupancy mask of neighbours, other points are scanned
+            // (matrix border consists of empty points, so offsets can't go out of matrix)
+            const bool has_mask = !point.IsEmpty();
+            for (const size_t i : offsets_order) {
+                if (has_mask && !(point.state->neighbours & (1u << i))) {
                     continue;
                 }
-                if (row >= max_rows || column >= max_cols) {
+
+                const auto [row_offset, column_offset] = point::kNeighbourOffsets[i];
+                const point::Point neighbour = grm.At(row + row_offset, column + column_offset);
+                if (!has_mask && neighbour.IsEmpty()) {
                     continue;
                 }
-
-                result.PushBack({row, column});
+                result.PushBack(neighbour);
             }
 
             return result;
@@ -31,53 +42,41 @@ namespace ogr::iterator {
     }
 
     struct Neighbourhood8 {
-        utils::StackVector<point::PointPtr, 8> operator()(const point::PointPtr &point, const matrix::Grm &grm) const {
-            const int row = static_cast<int>(point->row);
-            const int column = static_cast<int>(point->column);
-
-            const utils::StackVector<std::pair<int, int>, 8> candidates{
-                    {row - 1, column},
-                    {row,     column - 1},
-                    {row,     column + 1},
-                    {row + 1, column},
-                    {row - 1, column - 1},
-                    {row + 1, column + 1},
-                    {row + 1, column - 1},
-                    {row - 1, column + 1}
-            };
-
-            const auto prefiltered_candidates = detail::PreFilterNeighbours(candidates, matrix::Rows(grm),
-                                                                            matrix::Columns(grm));
-            const auto points = utils::MapMatrixItems(prefiltered_candidates, grm);
-            return filter::FilterEmptyPoints(points);
+        utils::StackVector<point::Point, 8> operator()(const point::Point &point, const matrix::Grm &grm) const {
+            static constexpr std::array<size_t, 8> kOffsetsOrder{0, 1, 2, 3, 4, 5, 6, 7};
+
+            if (point.IsEmpty()) {
+                return detail::CollectNeighbours(point, grm, kOffsetsOrder);
+            }
+
+            const int row = static_cast<int>(point.row);
+            const int column = static_cast<int>(point.column);
+
+            // Neighbours are enumerated in offsets order: from lowest set bit of mask
+            utils::StackVector<point::Point, 8> result;
+            for (uint32_t mask = point.state->neighbours; mask; mask &= mask - 1) {
+                const auto [row_offset, column_offset] = point::kNeighbourOffsets[std::countr_zero(mask)];
+                result.PushBack(grm.At(row + row_offset, column + column_offset));
+            }
+
+            return result;
         }
     };
 
     struct Neighbourhood4 {
-        utils::StackVector<point::PointPtr, 4> operator()(const point::PointPtr &point, const matrix::Grm &grm) const {
-            const int row = static_cast<int>(point->row);
-            const int column = static_cast<int>(point->column);
-
-            const utils::StackVector<std::pair<int, int>, 4> candidates{
-                    {row - 1, column},
-                    {row + 1, column},
-                    {row, column - 1},
-                    {row, column + 1}
-            };
-
-            const auto prefiltered_candidates = detail::PreFilterNeighbours(candidates, matrix::Rows(grm),
-                                                                            matrix::Columns(grm));
-
-            const auto points = utils::MapMatrixItems(prefiltered_candidates, grm);
-            return filter::FilterEmptyPoints(points);
+        utils::StackVector<point::Point, 4> operator()(const point::Point &point, const matrix::Grm &grm) const {
+            // Up, down, left, right
+            static constexpr std::array<size_t, 4> kOffsetsOrder{0, 3, 1, 2};
+
+            return detail::CollectNeighbours(point, grm, kOffsetsOrder);
         }
     };
 
     template <class TStackVector>
-    std::enable_if_t<std::is_same_v<typename TStackVector::ItemType, point::PointPtr>, bool>
-    ContainsPoint(const TStackVector& points, const point::PointPtr sample) {
-        for (const point::PointPtr point : points) {
-            if (point->row == sample->row && point->column == sample->column) {
+    std::enable_if_t<std::is_same_v<typename TStackVector::ItemType, point::Point>, bool>
+    ContainsPoint(const TStackVector& points, const point::Point& sample) {
+        for (const point::Point& point : points) {
+            if (point == sample) {
                 return true;
             }
         }
@@ -57,6 +57,12 @@ namespace ogr::map {
             return map_[key];
         }
 
+        /** Value of keys without insertion, default value if keys are absent */
+        Value Get(Keys... keys) const {
+            auto it = map_.find(MakeCompositeKey(keys...));
+            return it != map_.end() ? it->second : Value{};
+        }
+
         void Clear() override {
             map_.clear();
         }
@@ -69,6 +75,14 @@ namespace ogr::map {
             return map_.end();
         }
 
+        typename std::unordered_map<KeyType, Value>::const_iterator begin() const {
+            return map_.begin();
+        }
+
+        typename std::unordered_map<KeyType, Value>::const_iterator end() const {
+            return map_.end();
+        }
+
         size_t Size() const override {
             return map_.size();
         }
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <ogr_components/preprocessed_graph.h>
+#include <ogr_components/skeleton_index.h>
+#include <thinning/thinning.h>
+
+#include <opencv2/opencv.hpp>
+
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ogr {
+    /** Everything recognition is built from: skeleton, ink usage and vertex pixels */
+    struct IngestedImage {
+        uint32_t rows;
+        uint32_t columns;
+        uint64_t ink_pixels;
+        matrix::SkeletonIndex skeleton;
+
+        // Vertex color flag of every skeleton point in skeleton index order
+        std::vector<uint8_t> vertex_mask;
+    };
+
+    /**
+     * Single pass over colored image and its skeleton bits (PreprocessedGraph layout):
+     * ink pixels are counted, skeleton index is built and skeleton pixels are matched by vertex policy.
+     * Policy is called in bulk for every skeleton word: policy(pixels of word, skeleton bits) -> vertex bits.
+     */
+    template <typename TVertexPolicy>
+    IngestedImage IngestImage(const cv::Mat& colored_image, std::span<const uint64_t> skeleton_bits, const TVertexPolicy& vertex_policy) {
+        const uint32_t rows = static_cast<uint32_t>(colored_image.rows);
+        const uint32_t columns = static_cast<uint32_t>(colored_image.cols);
+        const size_t words_per_row = PreprocessedGraph::WordsPerRow(columns);
+        if (colored_image.type() != CV_8UC3 || skeleton_bits.size() != rows * words_per_row) {
+            throw std::runtime_error{"Skeleton doesn't match colored image"};
+        }
+
+        // Bits of last word of row which are out of image
+        const uint64_t padding = columns % 64 ? ~uint64_t{0} << (columns % 64) : 0;
+
+        IngestedImage image{.rows = rows, .columns = columns, .ink_pixels = 0};
+        for (uint32_t row = 0; row < rows; ++row) {
+            const cv::Vec3b* pixels = colored_image.ptr<cv::Vec3b>(static_cast<int>(row));
+
+            // Branchless count, so it is vectorized
+            uint64_t ink_pixels = 0;
+            for (uint32_t column = 0; column < columns; ++column) {
+                ink_pixels += thinning::IsInk(pixels[column]);
+            }
+            image.ink_pixels += ink_pixels;
+
+            const uint64_t* bits = skeleton_bits.data() + row * words_per_row;
+            if (words_per_row && (bits[words_per_row - 1] & padding)) {
+                throw std::runtime_error{"Skeleton point out of image"};
+            }
+
+            for (size_t word = 0; word < words_per_row; ++word) {
+                if (!bits[word]) {
+                    continue;
+                }
+
+                const uint64_t vertex_bits = vertex_policy(pixels + word * 64, bits[word]);
+                for (uint64_t word_bits = bits[word]; word_bits; word_bits &= word_bits - 1) {
+                    const int bit = std::countr_zero(word_bits);
+                    image.skeleton.PushPoint(row, static_cast<uint32_t>(word * 64 + bit));
+                    image.vertex_mask.push_back((vertex_bits >> bit) & 1);
+                }
+            }
+        }
+
+        return image;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <ogr_components/matrix.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ogr::matrix {
+    /**
+     * Private overlay of marks over graph recognition matrix.
+     * Crawlers mark points in layer instead of matrix, so matrix stays read-only during edges search
+     * and several vertexes can be crawled concurrently with own layers.
+     * Marks stored in matrix itself (non port vertex points) are considered permanent.
+     *
+     * Every point keeps epoch of its last mark: point is marked if its stamp equals current epoch,
+     * so Clear is just epoch increment (stamps are wiped only on epoch overflow).
+     * Only filled points are marked, so stamps are indexed by point rank and layer size follows amount of ink.
+     */
+    class MarkLayer {
+    public:
+        explicit MarkLayer(const Grm& grm)
+            : grm_(grm)
+            , stamps_(grm.PointsCount()) {
+        }
+
+        /** Layer memory per filled point */
+        static size_t PointBytes() {
+            return sizeof(uint16_t);
+        }
+
+        bool IsMarked(const point::Point& point) const {
+            return point::IsFilledPoint(point) && (point::IsMarkedPoint(point) || stamps_[grm_.Rank(point)] == epoch_);
+        }
+
+        void Mark(const point::Point& point) {
+            stamps_[grm_.Rank(point)] = epoch_;
+        }
+
+        void Clear() {
+            if (++epoch_ != 0) {
+                return;
+            }
+
+            std::fill(stamps_.begin(), stamps_.end(), 0);
+            epoch_ = 1;
+        }
+
+    private:
+        const Grm& grm_;
+        std::vector<uint16_t> stamps_;
+
+        // Zero stamp means point was never marked
+        uint16_t epoch_{1};
+    };
+}
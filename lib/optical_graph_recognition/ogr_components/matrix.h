@@ -1,37 +1,293 @@
 #pragma once
 
-#include <ogr_components/structured_elements.h>
-#include <utils/types.h>
-#include <utils/matrix_utils.h>
+#include <ogr_components/point.h>
+#include <utils/small_set.h>
+#include <utils/spill_array.h>
 
+#include <filesystem>
 #include <memory>
 #include <exception>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace ogr::matrix {
-    using GraphRecognitionMatrix = utils::Matrix<point::PointPtr>;
-    using Grm = GraphRecognitionMatrix;
+    /** Memory layout of points slots map of graph recognition matrix */
+    enum class Layout : uint8_t {
+        RowMajor,
+        // Row-major order of 8x8 tiles with row-major order inside tile,
+        // so vertical and diagonal neighbours mostly share cache lines
+        Tiled,
+        // Tiled layout where only tiles with skeleton points are allocated,
+        // all other tiles refer to single shared tile of empty points
+        Sparse
+    };
+
+    struct GridOptions {
+        Layout layout{Layout::RowMajor};
+
+        // Points slots map which doesn't fit into budget is spilled to memory mapped file in spill dir (0 is unlimited)
+        size_t memory_budget{0};
+        std::filesystem::path spill_dir;
+    };
+
+    /**
+     * Matrix of point states.
+     * States are stored only for filled points in order of their allocation (skeleton rank), every matrix cell
+     * keeps slot of its state in slots map, and zero slot is state shared by all empty points.
+     * So rank of filled point is known from its state handle without any lookup.
+     * Slots map doesn't change after construction, so copies of matrix share it and copy only point states.
+     * Matrix is surrounded with one pixel border of empty points,
+     * so neighbours of any inner point can be accessed without bounds checks.
+     */
+    class GraphRecognitionMatrix {
+    public:
+        // Most of edge points belong to 1-4 edges, bundles spill to heap
+        using EdgesList = utils::SmallSet<EdgeId, 4>;
+
+        struct EdgeEndpoints {
+            VertexId v1;
+            VertexId v2;
+        };
 
-    inline Grm MakeGraphRecognitionMatrix(const size_t rows, const size_t columns) {
-        utils::Matrix<point::PointPtr> matrix = utils::MakeMatrix<point::PointPtr>(rows, columns);
-        for (std::size_t row = 0; row < matrix.size(); ++row) {
-            for (std::size_t column = 0; column < matrix[row].size(); ++column) {
-                matrix[row][column] = std::make_shared<point::EmptyPoint>(row, column);
+    public:
+        /**
+         * Matrix with filled points enumerated by `for_each_point(callback(row, column))`,
+         * points get ranks in order of enumeration.
+         */
+        template <typename TForEachPoint>
+        GraphRecognitionMatrix(
+                const size_t rows,
+                const size_t columns,
+                TForEachPoint&& for_each_point,
+                const GridOptions& options = {}
+        )
+            : rows_(rows)
+            , columns_(columns)
+            , options_(options)
+            , stride_(options.layout == Layout::RowMajor ? columns + 2 : TilesCount(columns + 2)) {
+            auto map = std::make_shared<PointsMap>();
+            switch (options_.layout) {
+                case Layout::RowMajor:
+                    map->slots = MakeSlots((rows + 2) * stride_);
+                    break;
+                case Layout::Tiled:
+                    map->slots = MakeSlots(TilesCount(rows + 2) * stride_ * kTileArea);
+                    break;
+                case Layout::Sparse: {
+                    // Only tiles with filled points are allocated, zero tile is shared tile of empty points
+                    map->tiles.resize(TilesCount(rows + 2) * stride_, 0);
+                    uint32_t tiles_count = 1;
+                    for_each_point([&](const uint32_t row, const uint32_t column) {
+                        uint32_t& tile = map->tiles[TileIndex(row + 1, column + 1)];
+                        if (!tile) {
+                            tile = tiles_count++;
+                        }
+                    });
+
+                    map->slots = MakeSlots(static_cast<size_t>(tiles_count) * kTileArea);
+                    break;
+                }
             }
+
+            tiles_ = map->tiles.data();
+            slots_ = map->slots.data();
+            for_each_point([&](const uint32_t row, const uint32_t column) {
+                map->slots[Index(static_cast<int>(row), static_cast<int>(column))] = static_cast<uint32_t>(states_.size());
+                states_.push_back(point::PointState{.kind = point::PointKind::Filled});
+            });
+
+            map_ = std::move(map);
+        }
+
+        size_t Rows() const {
+            return rows_;
+        }
+
+        size_t Columns() const {
+            return columns_;
+        }
+
+        Layout GetLayout() const {
+            return options_.layout;
+        }
+
+        /** Points slots map is kept in spill file instead of heap */
+        bool IsSpilled() const {
+            return map_->slots.IsSpilled();
+        }
+
+        /** Memory budget of grid options (0 is unlimited) */
+        size_t MemoryBudget() const {
+            return options_.memory_budget;
         }
 
-        return matrix;
+        point::Point operator()(const size_t row, const size_t column) const {
+            return At(static_cast<int>(row), static_cast<int>(column));
+        }
+
+        /** Access to point with coordinates in range [-1, rows] x [-1, columns] (border included) */
+        point::Point At(const int row, const int column) const {
+            return point::Point{
+                .row = static_cast<uint32_t>(row),
+                .column = static_cast<uint32_t>(column),
+                .state = &states_[slots_[Index(row, column)]]
+            };
+        }
+
+        const point::PointState& StateAt(const int row, const int column) const {
+            return states_[slots_[Index(row, column)]];
+        }
+
+        /** Amount of filled points */
+        size_t PointsCount() const {
+            return states_.size() - 1;
+        }
+
+        /** Dense id of filled point in [0, PointsCount()), it's rank of point in allocation order */
+        size_t Rank(const point::Point& point) const {
+            return static_cast<size_t>(point.state - states_.data()) - 1;
+        }
+
+        void SetNeighboursMask(const point::Point& point, const uint8_t mask) {
+            point.state->neighbours = mask;
+        }
+
+        void MakeFilledPoint(const point::Point& point) {
+            *point.state = point::PointState{
+                .kind = point::PointKind::Filled,
+                .neighbours = point.state->neighbours
+            };
+        }
+
+        void MakeVertexPoint(const point::Point& point, const VertexId vertex_id) {
+            *point.state = point::PointState{
+                .kind = point::PointKind::Vertex,
+                .neighbours = point.state->neighbours,
+                .data = static_cast<uint32_t>(vertex_id)
+            };
+        }
+
+        void MakeEdgePoint(const point::Point& point) {
+            // Edge point inherits only dev mark from source filled point
+            const uint8_t flags = point.state->flags & point::kDevMarked;
+            *point.state = point::PointState{
+                .kind = point::PointKind::Edge,
+                .flags = flags,
+                .neighbours = point.state->neighbours,
+                .data = static_cast<uint32_t>(edges_lists_.size())
+            };
+            edges_lists_.emplace_back();
+        }
+
+        VertexId GetVertexId(const point::Point& point) const {
+            if (!point::IsVertexPoint(point)) {
+                throw std::runtime_error{"Point is not vertex point"};
+            }
+
+            return point.state->data;
+        }
+
+        EdgesList& GetEdges(const point::Point& point) const {
+            if (!point::IsEdgePoint(point)) {
+                throw std::runtime_error{"Point is not edge point"};
+            }
+
+            return edges_lists_[point.state->data];
+        }
+
+        /** Edge ids are dense, so endpoints of edges are stored in registry indexed by edge id */
+        void RegisterEdge(const EdgeId edge_id, const VertexId v1, const VertexId v2) {
+            if (edges_registry_.size() <= edge_id) {
+                edges_registry_.resize(edge_id + 1);
+            }
+            edges_registry_[edge_id] = EdgeEndpoints{.v1 = v1, .v2 = v2};
+        }
+
+        const EdgeEndpoints& GetEdgeEndpoints(const EdgeId edge_id) const {
+            return edges_registry_.at(edge_id);
+        }
+
+    private:
+        static constexpr size_t kTileShift = 3;
+        static constexpr size_t kTileSide = 1 << kTileShift;
+        static constexpr size_t kTileArea = kTileSide * kTileSide;
+        static constexpr size_t kTileMask = kTileSide - 1;
+
+        static size_t TilesCount(const size_t size) {
+            return (size + kTileSide - 1) >> kTileShift;
+        }
+
+        // For tiled layouts stride is amount of tiles in row of tiles
+        size_t TileIndex(const size_t r, const size_t c) const {
+            return (r >> kTileShift) * stride_ + (c >> kTileShift);
+        }
+
+        size_t Index(const int row, const int column) const {
+            const size_t r = static_cast<size_t>(row + 1);
+            const size_t c = static_cast<size_t>(column + 1);
+            if (options_.layout == Layout::RowMajor) {
+                return r * stride_ + c;
+            }
+
+            const size_t tile = options_.layout == Layout::Tiled ? TileIndex(r, c) : tiles_[TileIndex(r, c)];
+            return (tile << (2 * kTileShift)) | ((r & kTileMask) << kTileShift) | (c & kTileMask);
+        }
+
+        utils::SpillArray<uint32_t> MakeSlots(const size_t size) const {
+            const bool spill = options_.memory_budget && size * sizeof(uint32_t) > options_.memory_budget;
+            return utils::SpillArray<uint32_t>(size, spill ? std::make_optional(options_.spill_dir) : std::nullopt);
+        }
+
+    private:
+        size_t rows_;
+        size_t columns_;
+        GridOptions options_;
+        size_t stride_;
+
+        struct PointsMap {
+            // Sparse layout: index of every tile in slots
+            std::vector<uint32_t> tiles;
+
+            // Slot of state of every cell, zero slot is empty point
+            utils::SpillArray<uint32_t> slots;
+        };
+
+        // Map is shared by copies of matrix, its arrays are accessed through raw pointers
+        std::shared_ptr<const PointsMap> map_;
+        const uint32_t* tiles_{nullptr};
+        const uint32_t* slots_{nullptr};
+
+        // Point states are mutated through point handles (marks) even if matrix is shared as const
+        mutable std::vector<point::PointState> states_ = std::vector<point::PointState>(1);
+
+        // Side table with edges lists of edge points
+        mutable std::vector<EdgesList> edges_lists_;
+
+        std::vector<EdgeEndpoints> edges_registry_;
+    };
+
+    using Grm = GraphRecognitionMatrix;
+
+    template <typename TForEachPoint>
+    inline Grm MakeGraphRecognitionMatrix(
+            const size_t rows,
+            const size_t columns,
+            TForEachPoint&& for_each_point,
+            const GridOptions& options = {}
+    ) {
+        return Grm(rows, columns, std::forward<TForEachPoint>(for_each_point), options);
     }
 
     inline size_t Rows(const Grm& grm) {
-        return grm.size();
+        return grm.Rows();
     }
 
     inline size_t Columns(const Grm& grm) {
-        if (grm.empty()) {
+        if (!grm.Rows()) {
             throw std::runtime_error{"Grm is empty"};
         }
 
-        return grm[0].size();
+        return grm.Columns();
     }
 }
@@ -1,8 +1,9 @@
 #pragma once
 
-#include <utils/types.h>
 #include <utils/geometry.h>
 
+#include <array>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <set>
@@ -11,149 +12,167 @@
 namespace ogr {
     struct Vertex;
     struct Edge;
+
+    using VertexId = size_t;
+    using EdgeId = size_t;
 }
 
 namespace ogr::point {
-    struct IGraphRecognitionPoint;
-    struct FilledPoint;
-    struct VertexPoint;
-    struct EdgePoint;
-
-    using Point = IGraphRecognitionPoint;
-    using PointPtr = std::shared_ptr<Point>;
-    using WeakPointPtr = std::weak_ptr<Point>;
-
-    using FilledPointPtr = std::shared_ptr<FilledPoint>;
-    using VertexPointPtr = std::shared_ptr<VertexPoint>;
-
-    using EdgePointPtr = std::shared_ptr<EdgePoint>;
-    using EdgePointWeakPtr = std::weak_ptr<EdgePoint>;
+    // Point kind is a bitfield, so kind checks are single mask tests (vertex and edge points are filled too)
+    enum PointKindBits : uint8_t {
+        kFilledBit = 1 << 0,
+        kVertexBit = 1 << 1,
+        kEdgeBit = 1 << 2
+    };
 
-    struct IGraphRecognitionPoint {
-        const size_t row;
-        const size_t column;
+    enum class PointKind : uint8_t {
+        Empty = 0,
+        Filled = kFilledBit,
+        Vertex = kFilledBit | kVertexBit,
+        Edge = kFilledBit | kEdgeBit
+    };
 
-        IGraphRecognitionPoint(const size_t row, const size_t column) : row(row), column(column) {}
+    inline constexpr uint8_t KindBits(const PointKind kind) {
+        return static_cast<uint8_t>(kind);
+    }
 
-        virtual bool IsEmpty() const = 0;
-        virtual ~IGraphRecognitionPoint() = default;
+    enum PointFlags : uint8_t {
+        kMarked = 1 << 0,
+        kDevMarked = 1 << 1,
+        kPort = 1 << 2,
+        kCrossing = 1 << 3
     };
 
-    struct FilledPoint : IGraphRecognitionPoint {
-        using IGraphRecognitionPoint::IGraphRecognitionPoint;
-        bool dev_mark = false;
-
-        bool IsEmpty() const override {
-            return false;
-        }
+    /**
+     * Offsets of 8-neighbourhood, i-th bit of neighbours mask corresponds to i-th offset.
+     * Order of offsets defines order of neighbours enumeration.
+     */
+    inline constexpr std::array<std::pair<int, int>, 8> kNeighbourOffsets{{
+            {-1, 0},
+            {0,  -1},
+            {0,  1},
+            {1,  0},
+            {-1, -1},
+            {1,  1},
+            {1,  -1},
+            {-1, 1}
+    }};
+
+    /**
+     * Compact per pixel record of graph recognition matrix.
+     * `data` is vertex id for vertex points and index of edges side table entry for edge points.
+     * `neighbours` is occupancy mask of filled 8-neighbours, skeleton is static so it is computed once.
+     */
+    struct PointState {
+        PointKind kind{PointKind::Empty};
+        uint8_t flags{0};
+        uint8_t neighbours{0};
+        uint8_t reserved{0};
+        uint32_t data{0};
+    };
 
-        bool IsMarked() const {
-            return marked_;
-        }
+    static_assert(sizeof(PointState) == 8, "Point state should be kept compact");
 
-        void Mark() {
-            marked_ = true;
-        }
+    /** Lightweight handle of matrix point: coordinates + pointer to point state in matrix */
+    struct Point {
+        uint32_t row{0};
+        uint32_t column{0};
+        PointState* state{nullptr};
 
-        void ResetMark() {
-            marked_ = false;
+        bool IsEmpty() const {
+            return state->kind == PointKind::Empty;
         }
 
-    private:
-        bool marked_{false};
-    };
-
-    struct EmptyPoint : IGraphRecognitionPoint {
-        using IGraphRecognitionPoint::IGraphRecognitionPoint;
-
-        bool IsEmpty() const override {
-            return true;
+        bool operator==(const Point& other) const {
+            return row == other.row && column == other.column;
         }
     };
 
-    struct VertexPoint : FilledPoint {
-        using FilledPoint::FilledPoint;
-        std::weak_ptr<Vertex> vertex;
-        bool is_port_point{false};
-    };
+    /** Direction angle of vector from one point to another (x axis goes along columns, y axis along rows) */
+    template <int Radius>
+    inline utils::BinaryAngle DirectionAngle(const Point& from, const Point& to) {
+        return utils::DirectionAngle<Radius>(
+                static_cast<int>(to.column) - static_cast<int>(from.column),
+                static_cast<int>(to.row) - static_cast<int>(from.row));
+    }
 
-    struct EdgePoint : FilledPoint {
-        using FilledPoint::FilledPoint;
+    inline bool IsVertexPoint(const PointState& state) {
+        return KindBits(state.kind) & kVertexBit;
+    }
 
-        std::vector<std::weak_ptr<Edge>> edges;
+    inline bool IsEdgePoint(const PointState& state) {
+        return KindBits(state.kind) & kEdgeBit;
+    }
 
-        bool IsCrossing() const {
-            return crossing_;
-        }
+    inline bool IsFilledPoint(const PointState& state) {
+        return KindBits(state.kind) & kFilledBit;
+    }
 
-        void MarkAsCrossing() {
-            crossing_ = true;
-        }
+    inline bool IsMarkedPoint(const PointState& state) {
+        return IsFilledPoint(state) && (state.flags & kMarked);
+    }
 
-        void ResetCrossing() {
-            crossing_ = false;
-        }
+    inline bool IsPortPoint(const PointState& state) {
+        return IsVertexPoint(state) && (state.flags & kPort);
+    }
 
-    private:
-        bool crossing_{false};
-    };
+    inline bool IsCrossingPoint(const PointState& state) {
+        return IsEdgePoint(state) && (state.flags & kCrossing);
+    }
 
-    inline utils::PlanarVector operator-(const Point& p1, const Point& p2) {
-        return utils::PlanarVector {
-            .x = static_cast<double>(p1.column) - p2.column,
-            .y = static_cast<double>(p1.row) - p2.row
-        };
+    inline bool IsDevMarked(const PointState& state) {
+        return IsFilledPoint(state) && (state.flags & kDevMarked);
     }
 
-    inline bool IsVertexPoint(const PointPtr& point) {
-        return utils::Is<VertexPoint>(point.get());
+    inline bool IsVertexPoint(const Point& point) {
+        return IsVertexPoint(*point.state);
     }
 
-    inline bool IsEdgePoint(const PointPtr& point) {
-        return utils::Is<EdgePoint>(point.get());
+    inline bool IsEdgePoint(const Point& point) {
+        return IsEdgePoint(*point.state);
     }
 
-    inline bool IsMarkedPoint(const PointPtr& point) {
-        if (FilledPointPtr filled_point = std::dynamic_pointer_cast<FilledPoint>(point)) {
-            return filled_point->IsMarked();
-        }
+    inline bool IsMarkedPoint(const Point& point) {
+        return IsMarkedPoint(*point.state);
+    }
 
-        return false;
+    inline bool IsPortPoint(const Point& point) {
+        return IsPortPoint(*point.state);
     }
 
-    inline bool IsPortPoint(const PointPtr& point) {
-        return utils::Is<VertexPoint>(point.get()) && utils::As<VertexPoint>(point.get())->is_port_point;
+    inline bool IsFilledPoint(const Point& point) {
+        return IsFilledPoint(*point.state);
     }
 
-    inline bool IsFilledPoint(const PointPtr& point) {
-        return utils::Is<FilledPoint>(point.get());
+    inline bool IsCrossingPoint(const Point& point) {
+        return IsCrossingPoint(*point.state);
     }
 
-    inline bool IsCrossingPoint(const PointPtr& point) {
-        return utils::Is<EdgePoint>(point.get()) && utils::As<EdgePoint>(point.get())->IsCrossing();
+    inline bool IsDevMarked(const Point& point) {
+        return IsDevMarked(*point.state);
     }
 
-    inline void Unmark(const PointPtr& point) {
-        utils::As<FilledPoint>(point.get())->ResetMark();
+    inline void Unmark(const Point& point) {
+        point.state->flags &= ~kMarked;
     }
 
-    inline void Mark(const PointPtr& point) {
-        utils::As<FilledPoint>(point.get())->Mark();
+    inline void Mark(const Point& point) {
+        point.state->flags |= kMarked;
     }
 
-    inline void MarkAsCrossing(const point::PointPtr& point) {
-        std::dynamic_pointer_cast<point::EdgePoint>(point)->MarkAsCrossing();
+    inline void MarkAsPort(const Point& point) {
+        point.state->flags |= kPort;
     }
 
-    inline void DevMark(const point::PointPtr& point) {
-        std::dynamic_pointer_cast<point::FilledPoint>(point)->dev_mark = true;
+    inline void MarkAsCrossing(const Point& point) {
+        point.state->flags |= kCrossing;
     }
 
-    inline bool IsDevMarked(const point::PointPtr& point) {
-        if (point::FilledPointPtr filled_point = std::dynamic_pointer_cast<point::FilledPoint>(point)) {
-            return filled_point->dev_mark;
-        }
+    inline void ResetCrossing(const Point& point) {
+        point.state->flags &= ~kCrossing;
+    }
 
-        return false;
+    inline void DevMark(const Point& point) {
+        point.state->flags |= kDevMarked;
     }
 }
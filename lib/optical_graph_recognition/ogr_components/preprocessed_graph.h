@@ -0,0 +1,36 @@
+#pragma once
+
+#include <ogr_components/point.h>
+
+#include <cstdint>
+#include <span>
+
+namespace ogr {
+    /** Pixel of detected vertex */
+    struct VertexPixel {
+        uint32_t row;
+        uint32_t column;
+        uint32_t vertex_id;
+        uint32_t is_port;
+    };
+
+    /**
+     * Result of image preprocessing (thinning and vertexes detection), it doesn't depend on algo params.
+     * Graph only refers to its data, so it can be restored right from memory mapped file.
+     */
+    struct PreprocessedGraph {
+        uint32_t rows;
+        uint32_t columns;
+        uint64_t inc_usage;
+
+        // Skeleton bits in row-major order, every row is padded to whole words
+        std::span<const uint64_t> skeleton_bits;
+
+        // Vertex pixels in row-major order
+        std::span<const VertexPixel> vertex_pixels;
+
+        static size_t WordsPerRow(const uint32_t columns) {
+            return (static_cast<size_t>(columns) + 63) / 64;
+        }
+    };
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <ogr_components/matrix.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace ogr::matrix {
+    /**
+     * Sparse index of filled (skeleton) points of graph recognition matrix.
+     * Points are stored in row-major order: sorted columns list + row offsets (CSR layout),
+     * so passes over skeleton scale with amount of ink instead of image area.
+     */
+    class SkeletonIndex {
+    public:
+        SkeletonIndex() : row_offsets_{0} {}
+
+        /** Points should be pushed in row-major order */
+        void PushPoint(const uint32_t row, const uint32_t column) {
+            assert(row + 2 >= row_offsets_.size());
+
+            while (row_offsets_.size() < static_cast<size_t>(row) + 2) {
+                row_offsets_.push_back(columns_.size());
+            }
+
+            assert(row_offsets_[row] == columns_.size() || columns_.back() < column);
+            columns_.push_back(column);
+            row_offsets_.back() = columns_.size();
+        }
+
+        size_t Size() const {
+            return columns_.size();
+        }
+
+        /** Number of rows that contain index data (rows after last filled row are omitted) */
+        size_t Rows() const {
+            return row_offsets_.size() - 1;
+        }
+
+        /** Rank of point in row-major order, it's dense id of skeleton point */
+        std::optional<size_t> Find(const uint32_t row, const uint32_t column) const {
+            if (row >= Rows()) {
+                return std::nullopt;
+            }
+
+            const auto begin = columns_.begin() + row_offsets_[row];
+            const auto end = columns_.begin() + row_offsets_[row + 1];
+            const auto it = std::lower_bound(begin, end, column);
+            if (it == end || *it != column) {
+                return std::nullopt;
+            }
+
+            return static_cast<size_t>(it - columns_.begin());
+        }
+
+        template <typename TFunc>
+        void ForEach(TFunc&& func) const {
+            for (size_t row = 0; row < Rows(); ++row) {
+                for (size_t i = row_offsets_[row]; i < row_offsets_[row + 1]; ++i) {
+                    func(static_cast<uint32_t>(row), columns_[i]);
+                }
+            }
+        }
+
+    private:
+        std::vector<uint32_t> columns_;
+        std::vector<size_t> row_offsets_;
+    };
+
+    namespace detail {
+        // Maps 3x3 window (bit 3 * (row_offset + 1) + (column_offset + 1)) to neighbours mask
+        inline constexpr std::array<uint8_t, 512> MakeWindowToNeighboursTable() {
+            std::array<uint8_t, 512> table{};
+            for (size_t window = 0; window < table.size(); ++window) {
+                for (size_t i = 0; i < point::kNeighbourOffsets.size(); ++i) {
+                    const auto [row_offset, column_offset] = point::kNeighbourOffsets[i];
+                    if (window & (1u << (3 * (row_offset + 1) + (column_offset + 1)))) {
+                        table[window] |= 1u << i;
+                    }
+                }
+            }
+
+            return table;
+        }
+
+        inline constexpr std::array<uint8_t, 512> kWindowToNeighbours = MakeWindowToNeighboursTable();
+    }
+
+    /**
+     * One time pass that stores 8-neighbours occupancy mask in every skeleton point of matrix.
+     * Skeleton is packed to bit rows (with one bit border), so 3x3 window of point is 3 shifts + table lookup.
+     */
+    inline void BuildNeighboursMasks(const SkeletonIndex& skeleton, Grm& grm) {
+        const size_t words_per_row = (grm.Columns() + 2 + 63) / 64;
+        std::vector<uint64_t> bits((skeleton.Rows() + 2) * words_per_row, 0);
+
+        auto bit_row = [&](const size_t padded_row) {
+            return bits.data() + padded_row * words_per_row;
+        };
+
+        skeleton.ForEach([&](const uint32_t row, const uint32_t column) {
+            const size_t padded_column = column + 1;
+            bit_row(row + 1)[padded_column >> 6] |= uint64_t{1} << (padded_column & 63);
+        });
+
+        // Bits of padded columns [column - 1, column + 1] of point with given column
+        auto window_row = [&](const uint64_t* row_bits, const uint32_t column) -> uint32_t {
+            const size_t shift = column & 63;
+            uint64_t window = row_bits[column >> 6] >> shift;
+            if (shift > 61) {
+                window |= row_bits[(column >> 6) + 1] << (64 - shift);
+            }
+
+            return window & 0b111;
+        };
+
+        skeleton.ForEach([&](const uint32_t row, const uint32_t column) {
+            const uint32_t window = window_row(bit_row(row), column)
+                    | window_row(bit_row(row + 1), column) << 3
+                    | window_row(bit_row(row + 2), column) << 6;
+            grm.SetNeighboursMask(grm(row, column), detail::kWindowToNeighbours[window]);
+        });
+    }
+}
+
+namespace ogr::utils {
+    template <typename TFunc>
+    inline void ForAll(const matrix::SkeletonIndex& skeleton, const matrix::Grm& grm, TFunc&& func) {
+        skeleton.ForEach([&](const uint32_t row, const uint32_t column) {
+            func(grm(row, column));
+        });
+    }
+}
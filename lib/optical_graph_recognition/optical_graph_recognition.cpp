@@ -1,5 +1,6 @@
 #include "optical_graph_recognition.h"
 
+#include <utils/opencv_utils.h>
 #include <utils/stack_vector.h>
 #include <utils/debug.h>
 #include <crawler/edges_detector.h>
@@ -7,10 +8,14 @@
 #include <algo_utils/sampling.h>
 #include <map/composite_map.h>
 #include <map/reset_decorator.h>
+#include <snapshot/snapshot.h>
 
 #include <plog/Log.h>
-#include <tabulate/table.hpp>
+#include <thread_pool.hpp>
 
+#include <atomic>
+#include <bit>
+#include <future>
 #include <string>
 
 
@@ -28,66 +33,158 @@ namespace std {
 
 namespace ogr {
     namespace {
-        matrix::Grm MakeGraphRecognitionMatrixFromCvMatrix(const cv::Mat& image) {
-            const size_t rows = image.rows;
-            const size_t columns = image.cols;
-            matrix::Grm grm = matrix::MakeGraphRecognitionMatrix(rows, columns);
-
-            for (size_t row = 0; row < rows; ++row) {
-                for (size_t column = 0; column < columns; ++column) {
-                    const cv::Point cv_point(column, row);
-                    const uint8_t value = image.at<uint8_t>(cv_point);
-                    if (value != 0) {
-                        grm[row][column] = std::make_shared<point::FilledPoint>(row, column);
+        matrix::SkeletonIndex MakeSkeletonIndexFromBits(const PreprocessedGraph& graph) {
+            const size_t words_per_row = PreprocessedGraph::WordsPerRow(graph.columns);
+            if (graph.skeleton_bits.size() != graph.rows * words_per_row) {
+                throw std::runtime_error{"Invalid skeleton bits size"};
+            }
+
+            matrix::SkeletonIndex skeleton;
+            for (uint32_t row = 0; row < graph.rows; ++row) {
+                for (size_t word = 0; word < words_per_row; ++word) {
+                    for (uint64_t bits = graph.skeleton_bits[row * words_per_row + word]; bits; bits &= bits - 1) {
+                        const size_t column = word * 64 + std::countr_zero(bits);
+                        if (column >= graph.columns) {
+                            throw std::runtime_error{"Skeleton point out of image"};
+                        }
+
+                        skeleton.PushPoint(row, static_cast<uint32_t>(column));
                     }
                 }
             }
 
+            return skeleton;
+        }
+
+        matrix::Grm MakeGraphRecognitionMatrix(
+                const size_t rows,
+                const size_t columns,
+                const matrix::SkeletonIndex& skeleton,
+                const matrix::GridOptions& grid_options
+        ) {
+            // Points are allocated in skeleton order, so their ranks in matrix and skeleton index are same
+            matrix::Grm grm = matrix::MakeGraphRecognitionMatrix(rows, columns, [&](auto&& allocate) {
+                skeleton.ForEach(allocate);
+            }, grid_options);
+            matrix::BuildNeighboursMasks(skeleton, grm);
+
+            if (grm.IsSpilled()) {
+                LOG_INFO << "Recognition grid exceeds memory budget, it is spilled to " << grid_options.spill_dir;
+            }
+
             return grm;
         }
     }
 
-    OpticalGraphRecognition::OpticalGraphRecognition(const cv::Mat &source_graph, const std::string& filename)
-        : grm_(MakeGraphRecognitionMatrixFromCvMatrix(source_graph))
+    OpticalGraphRecognition::OpticalGraphRecognition(
+            IngestedImage image,
+            const std::string& filename,
+            const matrix::GridOptions& grid_options
+    )
+        : skeleton_(std::make_shared<const matrix::SkeletonIndex>(std::move(image.skeleton)))
+        , grm_(MakeGraphRecognitionMatrix(image.rows, image.columns, *skeleton_, grid_options))
+        , inc_usage_(image.ink_pixels)
         , filename_(filename) {
+        DetectVertexes(image.vertex_mask);
     }
 
-    void OpticalGraphRecognition::UpdateIncUsage(const cv::Mat &source_image) {
-        for (size_t row = 0; row < source_image.rows; ++row) {
-            for (size_t column = 0; column < source_image.cols; ++column) {
-                const cv::Point cv_point(column, row);
-                const uint8_t value = source_image.at<uint8_t>(cv_point);
-                if (value != 0) {
-                    inc_usage_++;
-                }
+    OpticalGraphRecognition::OpticalGraphRecognition(
+            const PreprocessedGraph& graph,
+            const std::string& filename,
+            const matrix::GridOptions& grid_options
+    )
+        : skeleton_(std::make_shared<const matrix::SkeletonIndex>(MakeSkeletonIndexFromBits(graph)))
+        , grm_(MakeGraphRecognitionMatrix(graph.rows, graph.columns, *skeleton_, grid_options))
+        , inc_usage_(graph.inc_usage)
+        , filename_(filename) {
+        // Vertex pixels are in order of vertexes detection, so vertexes and their points are restored in same order
+        for (const VertexPixel& pixel : graph.vertex_pixels) {
+            if (pixel.row >= graph.rows || pixel.column >= graph.columns) {
+                throw std::runtime_error{"Vertex pixel out of image"};
+            }
+
+            const point::Point point = grm_(pixel.row, pixel.column);
+            if (!point::IsFilledPoint(point)) {
+                throw std::runtime_error{"Vertex pixel is not skeleton point"};
+            }
+
+            VertexPtr& vertex = vertexes_[pixel.vertex_id];
+            if (!vertex) {
+                vertex = std::make_shared<Vertex>(pixel.vertex_id);
+            }
+
+            grm_.MakeVertexPoint(point, pixel.vertex_id);
+            vertex->points.push_back(point);
+
+            if (pixel.is_port) {
+                point::MarkAsPort(point);
+                vertex->port_points.push_back(point);
+            } else {
+                point::Mark(point);
+            }
+        }
+    }
+
+    OpticalGraphRecognition::OpticalGraphRecognition(const OpticalGraphRecognition& other)
+        : skeleton_(other.skeleton_)
+        , grm_(other.grm_)
+        , vertexes_(other.vertexes_)
+        , edges_(other.edges_)
+        , crossing_areas_(other.crossing_areas_)
+        , bundling_map_(other.bundling_map_)
+        , edge_lengths_(other.edge_lengths_)
+        , inc_usage_(other.inc_usage_)
+        , beam_width_(other.beam_width_)
+        , pruned_crawlers_(other.pruned_crawlers_)
+        , edge_stats_(other.edge_stats_)
+        , filename_(other.filename_) {
+        // Maps are copied as is to keep their iteration order, only objects and their points are replaced
+        auto rebase = [&](std::vector<point::Point>& points) {
+            for (point::Point& point : points) {
+                point = grm_(point.row, point.column);
             }
+        };
+
+        for (auto& [_, vertex] : vertexes_) {
+            vertex = std::make_shared<Vertex>(*vertex);
+            rebase(vertex->points);
+            rebase(vertex->port_points);
+        }
+
+        for (auto& [_, edge] : edges_) {
+            edge = std::make_shared<Edge>(*edge);
+            rebase(edge->points);
+        }
+
+        for (auto& [_, points] : crossing_areas_) {
+            rebase(points);
         }
     }
 
-    void OpticalGraphRecognition::DetectVertexes(std::function<bool(point::PointPtr)> is_vertex) {
+    void OpticalGraphRecognition::DetectVertexes(const std::vector<uint8_t>& vertex_mask) {
         LOG_DEBUG << "Detect vertexes process start";
 
-        algo::PointsGluer<iterator::Neighbourhood8> gluer(grm_);
+        if (vertex_mask.size() != skeleton_->Size()) {
+            throw std::runtime_error{"Vertex mask doesn't match skeleton"};
+        }
 
-        utils::ForAll(grm_, [&](point::PointPtr &point) {
-            // Consider only filled points
-            if (point->IsEmpty()) {
-                return;
-            }
+        algo::PointsGluer<iterator::Neighbourhood8> gluer(grm_, *skeleton_);
 
-            if (is_vertex(point)) {
+        size_t index = 0;
+        utils::ForAll(*skeleton_, grm_, [&](const point::Point& point) {
+            if (vertex_mask[index++]) {
                 gluer.AddPoint(point);
             }
         });
 
         LOG_DEBUG << "Building vertexes objects from vertex points";
 
-        utils::ForAll(grm_, [&](point::PointPtr &point) {
+        utils::ForAll(*skeleton_, grm_, [&](const point::Point& point) {
             if (!gluer.ContainsPoint(point)) {
                 return;
             }
 
-            LOG_DEBUG << "Process vertex point: " << debug::DebugDump(*point);
+            LOG_DEBUG << "Process vertex point: " << debug::DebugDump(point);
 
             VertexId vid = gluer.GetGroupId(point);
 
@@ -95,14 +192,12 @@ namespace ogr {
                 vertexes_[vid] = std::make_shared<Vertex>(vid);
             }
 
-            point::VertexPointPtr vpoint = std::make_shared<point::VertexPoint>(point->row, point->column);
+            grm_.MakeVertexPoint(point, vid);
 
             // Mark vertex point, to avoid iterator iterate over these points
-            vpoint->Mark();
+            point::Mark(point);
 
-            point = vpoint;
-            vertexes_[vid]->points.push_back(vpoint);
-            vpoint->vertex = vertexes_[vid];
+            vertexes_[vid]->points.push_back(point);
         });
 
         LOG_DEBUG << "End vertexes detecting";
@@ -110,10 +205,40 @@ namespace ogr {
         DetectPortPoints();
     }
 
+    PreprocessedGraph OpticalGraphRecognition::GetPreprocessedGraph(
+            std::vector<uint64_t>& skeleton_bits,
+            std::vector<VertexPixel>& vertex_pixels
+    ) const {
+        const size_t words_per_row = PreprocessedGraph::WordsPerRow(grm_.Columns());
+        skeleton_bits.assign(grm_.Rows() * words_per_row, 0);
+        vertex_pixels.clear();
+
+        skeleton_->ForEach([&](const uint32_t row, const uint32_t column) {
+            skeleton_bits[row * words_per_row + (column >> 6)] |= uint64_t{1} << (column & 63);
+
+            const point::Point point = grm_(row, column);
+            if (point::IsVertexPoint(point)) {
+                vertex_pixels.push_back(VertexPixel{
+                    .row = row,
+                    .column = column,
+                    .vertex_id = static_cast<uint32_t>(grm_.GetVertexId(point)),
+                    .is_port = point::IsPortPoint(point)
+                });
+            }
+        });
+
+        return PreprocessedGraph{
+            .rows = static_cast<uint32_t>(grm_.Rows()),
+            .columns = static_cast<uint32_t>(grm_.Columns()),
+            .inc_usage = inc_usage_,
+            .skeleton_bits = skeleton_bits,
+            .vertex_pixels = vertex_pixels
+        };
+    }
+
     void OpticalGraphRecognition::DetectPortPoints() {
         for (auto& [_, vertex] : vertexes_) {
-            for (auto& point : vertex->points) {
-                point::VertexPointPtr vertex_point = point.lock();
+            for (const point::Point& vertex_point : vertex->points) {
                 iterator::Neighbourhood8 neighbourhood;
                 auto neighbours = neighbourhood(vertex_point, grm_);
                 neighbours = iterator::filter::FilterVertexPoints(neighbours);
@@ -121,47 +246,115 @@ namespace ogr {
                     continue;
                 }
 
-                vertex_point->ResetMark();
-                vertex_point->is_port_point = true;
+                point::Unmark(vertex_point);
+                point::MarkAsPort(vertex_point);
                 vertex->port_points.push_back(vertex_point);
             }
         }
     }
 
-    void OpticalGraphRecognition::DetectEdges(std::optional<VertexId> vertex_id) {
+    void OpticalGraphRecognition::DetectEdges(
+            const AlgoParams& params,
+            std::optional<VertexId> vertex_id,
+            bool locality_order,
+            size_t threads,
+            size_t beam_width,
+            const crawler::CrawlerSizes& crawler_sizes
+    ) {
         LOG_DEBUG << "Start detect edges";
 
+        beam_width_ = beam_width;
+
         debug::DebugDump(grm_);
-        size_t edge_id_counter = 0;
 
-        for (const auto&[_, vertex]: vertexes_) {
-            // Useful for debugging
-            if (vertex_id.has_value() && vertex->id != *vertex_id) {
-                continue;
+        std::vector<VertexPtr> vertexes;
+        if (locality_order) {
+            // Neighbouring vertexes are processed one after another to reuse cached parts of matrix
+            vertexes = GetVertexesInLocalityOrder();
+        } else {
+            // Vertexes go in ids order, so edge ids don't depend on hash map state (e.g. of copied recognition)
+            for (const auto& [_, vertex] : vertexes_) {
+                vertexes.push_back(vertex);
             }
 
-            LOG_INFO << "Detect edges for vertex with id = " << vertex->id;
+            std::sort(vertexes.begin(), vertexes.end(), [](const VertexPtr& lhs, const VertexPtr& rhs) {
+                return lhs->id < rhs->id;
+            });
+        }
 
-            std::vector<EdgePtr> found_edges = crawler::FindEdges(*vertex, grm_, edge_id_counter);
+        // Useful for debugging
+        if (vertex_id.has_value()) {
+            std::erase_if(vertexes, [&](const VertexPtr& vertex) {
+                return vertex->id != *vertex_id;
+            });
+        }
+
+        // Skeleton is static while edges are crawled, so its segments are shared by all vertexes
+        const crawler::SegmentGraph segments(*skeleton_, grm_, crawler_sizes.step_size);
 
-            for (const EdgePtr edge : found_edges) {
+        // Edges are stored in matrix in vertexes order, so edge ids don't depend on threads count
+        EdgeId first_edge_id = 0;
+        auto commit_edges = [&](const std::vector<EdgePtr>& found_edges) {
+            crawler::CommitEdges(found_edges, first_edge_id, grm_);
+            first_edge_id += found_edges.size();
+
+            for (const EdgePtr& edge : found_edges) {
                 LOG_INFO << "Found edge with id = " << edge->id << " source vertex = " << edge->v1 << " sink vertex = " << edge->v2;
                 edges_[edge->id] = edge;
             }
+        };
 
-            debug::DebugDump(grm_, vertex->id);
+        // Every worker keeps mark layer and walker stamps of skeleton size, they are counted against memory budget
+        const size_t worker_overlays_size = skeleton_->Size() * (matrix::MarkLayer::PointBytes() + crawler::StepsWalker::PointBytes());
+        if (grm_.MemoryBudget() && threads * worker_overlays_size > grm_.MemoryBudget()) {
+            threads = std::max<size_t>(grm_.MemoryBudget() / worker_overlays_size, 1);
+            LOG_INFO << "Edges detection workers are limited to " << threads << " by memory budget";
+        }
 
-            utils::ForAll(grm_, [](const point::PointPtr& point) {
-                if (point::IsFilledPoint(point)) {
-                    point::Unmark(point);
-                }
+        // Intermediate results dumps are sequential
+        if (threads <= 1 || !debug::DevDirPath.empty()) {
+            matrix::MarkLayer marks(grm_);
+            crawler::StepsWalker walker(grm_, marks);
+            for (const VertexPtr& vertex : vertexes) {
+                LOG_INFO << "Detect edges for vertex with id = " << vertex->id;
+
+                commit_edges(crawler::FindEdges(*vertex, grm_, marks, walker, segments, params, crawler_sizes, beam_width, pruned_crawlers_));
+                marks.Clear();
 
-                if (point::IsVertexPoint(point) && !point::IsPortPoint(point)) {
-                    point::Mark(point);
+                debug::DebugDump(grm_, vertex->id);
+            }
+
+            return;
+        }
+
+        // Matrix is read only while vertexes are crawled: every worker marks points in own layer
+        std::vector<std::vector<EdgePtr>> vertexes_edges(vertexes.size());
+        std::vector<size_t> vertexes_pruned_crawlers(vertexes.size(), 0);
+        std::atomic<size_t> next_vertex{0};
+
+        thread_pool pool(threads);
+        std::vector<std::future<void>> workers;
+        for (size_t i = 0; i < threads; ++i) {
+            workers.push_back(pool.submit([&]() {
+                matrix::MarkLayer marks(grm_);
+                crawler::StepsWalker walker(grm_, marks);
+                for (size_t idx = next_vertex++; idx < vertexes.size(); idx = next_vertex++) {
+                    LOG_INFO << "Detect edges for vertex with id = " << vertexes[idx]->id;
+
+                    vertexes_edges[idx] = crawler::FindEdges(
+                            *vertexes[idx], grm_, marks, walker, segments, params, crawler_sizes, beam_width, vertexes_pruned_crawlers[idx]);
+                    marks.Clear();
                 }
-            });
+            }));
+        }
 
-            debug::DebugDump(grm_, vertex->id);
+        for (auto& worker : workers) {
+            worker.get();
+        }
+
+        for (size_t idx = 0; idx < vertexes.size(); ++idx) {
+            commit_edges(vertexes_edges[idx]);
+            pruned_crawlers_ += vertexes_pruned_crawlers[idx];
         }
     }
 
@@ -201,7 +394,7 @@ namespace ogr {
             processed_.insert(key);
             EdgeKey mirrored_key = make_mirror_key(key);
             if (intersect && !edges_map.contains(mirrored_key)) {
-                edge->Reset();
+                edge->Reset(grm_);
                 continue;
             }
 
@@ -221,30 +414,25 @@ namespace ogr {
 
         edges_ = std::move(next_edges_);
         ClearGrmFromUnusedEdgePoints();
-
-        for (const auto& [eid, edge] : edges_) {
-            adjacency_map_(edge->v1, edge->v2) = eid;
-        }
     }
 
     EdgePtr OpticalGraphRecognition::ChooseBestEdge(EdgePtr e1, EdgePtr e2) {
         if (e1->irregularity < e2->irregularity) {
             LOG_DEBUG << "Reset edge id = " << e2->id;
-            e2->Reset();
+            e2->Reset(grm_);
             return e1;
         }
 
         LOG_DEBUG << "Reset edge id = " << e1->id;
-        e1->Reset();
+        e1->Reset(grm_);
         return e2;
     }
 
     void OpticalGraphRecognition::ClearGrmFromUnusedEdgePoints() {
-        utils::ForAll(grm_, [](point::PointPtr& point) {
+        utils::ForAll(*skeleton_, grm_, [&](const point::Point& point) {
            if (point::IsEdgePoint(point)) {
-               point::EdgePointPtr edge_point = std::dynamic_pointer_cast<point::EdgePoint>(point);
-               if (edge_point->edges.empty()) {
-                   point = std::make_shared<point::FilledPoint>(point->row, point->column);
+               if (grm_.GetEdges(point).Empty()) {
+                   grm_.MakeFilledPoint(point);
                }
            }
         });
@@ -258,7 +446,7 @@ namespace ogr {
             }
 
             std::filesystem::path image_path = output_dir / (base_name + std::to_string(vid) + ".png");
-            cv::Mat mat = opencv::Grm2CvMat(grm_, utils::EdgePointFilterWithVertex{vid});
+            cv::Mat mat = opencv::Grm2CvMat(grm_, utils::EdgePointFilterWithVertex(vid));
 
             LOG_INFO << "Dump detected edges for vertex with id = " << vid;
             cv::imwrite(image_path, mat);
@@ -268,7 +456,7 @@ namespace ogr {
             const std::string edges_base_name = "edge_";
             for (EdgeId eid : GetEdgesIds()) {
                 std::filesystem::path image_path = output_dir / (edges_base_name + std::to_string(eid) + ".png");
-                cv::Mat mat = opencv::Grm2CvMat(grm_, utils::EdgePointFilter{eid});
+                cv::Mat mat = opencv::Grm2CvMat(grm_, utils::EdgePointFilter(eid));
 
                 LOG_INFO << "Dump edge image with id = " << eid;
                 cv::imwrite(image_path, mat);
@@ -314,9 +502,8 @@ namespace ogr {
 
         map::ResetMapDecorator<kResetMapDecoratorThreshold, size_t, EdgeId, EdgeId> lengths(map::CompositeMap<size_t, EdgeId, EdgeId>{});
 
-        for (point::EdgePointWeakPtr weak_point : edge->points) {
-            point::EdgePointPtr point = weak_point.lock();
-            auto edges = point::GetEdgesSet(point);
+        for (const point::Point& point : edge->points) {
+            const auto& edges = grm_.GetEdges(point);
             auto edge_pairs = algo::GetUniquePairs(edges);
             for (auto& [e1, e2] : edge_pairs) {
                 edge_lengths_(e1, e2) = std::max(++lengths(e1, e2), edge_lengths_(e1, e2));
@@ -331,26 +518,25 @@ namespace ogr {
     }
 
     void OpticalGraphRecognition::MarkCrossingsPoints() {
-        algo::PointsGluer<iterator::Neighbourhood8> gluer(grm_);
-        utils::ForAll(grm_, [&](const point::PointPtr& point) {
+        algo::PointsGluer<iterator::Neighbourhood8> gluer(grm_, *skeleton_);
+        utils::ForAll(*skeleton_, grm_, [&](const point::Point& point) {
             if (!point::IsEdgePoint(point)) {
                 return;
             }
 
-            const point::EdgePointPtr edge_point = std::dynamic_pointer_cast<point::EdgePoint>(point);
-            if (IsCrossingPoint(edge_point)) {
-                gluer.AddPoint(edge_point);
-                edge_point->MarkAsCrossing();
+            if (IsCrossingPoint(point)) {
+                gluer.AddPoint(point);
+                point::MarkAsCrossing(point);
             }
         });
 
         iterator::Neighbourhood8 ngh;
         std::set<size_t> invalid_crossings;
 
-        for (point::PointPtr point : gluer.GetPoints()) {
+        for (const point::Point& point : gluer.GetPoints()) {
             const size_t crossing_id = gluer.GetGroupId(point);
             crossing_areas_[crossing_id].push_back(point);
-            for (const point::PointPtr neighbour : ngh(point, grm_)) {
+            for (const point::Point& neighbour : ngh(point, grm_)) {
                 if (point::IsVertexPoint(neighbour)) {
                     invalid_crossings.insert(crossing_id);
                 }
@@ -359,20 +545,19 @@ namespace ogr {
 
         // Erase crossing ares in neighbourhood of vertex
         for (const size_t& crossing_id : invalid_crossings) {
-            for (point::PointPtr point : crossing_areas_[crossing_id]) {
-                point::EdgePointPtr edge_point = std::dynamic_pointer_cast<point::EdgePoint>(point);
-                edge_point->ResetCrossing();
+            for (const point::Point& point : crossing_areas_[crossing_id]) {
+                point::ResetCrossing(point);
             }
             crossing_areas_.erase(crossing_id);
         }
     }
 
-    bool OpticalGraphRecognition::IsCrossingPoint(const point::EdgePointPtr& point) {
-        auto edges = point::GetEdgesSet(point);
+    bool OpticalGraphRecognition::IsCrossingPoint(const point::Point& point) {
+        const auto& edges = grm_.GetEdges(point);
         auto edge_pairs = algo::GetUniquePairs(edges);
         for (const auto& [e1, e2] : edge_pairs) {
             if (!bundling_map_.Contains(e1, e2)) {
-                LOG_DEBUG << "Found crossing point: " << debug::DebugDump(*point) << " edge1 = " << e1 << " edge2 = " << e2;
+                LOG_DEBUG << "Found crossing point: " << debug::DebugDump(point) << " edge1 = " << e1 << " edge2 = " << e2;
                 return true;
             }
         }
@@ -380,6 +565,33 @@ namespace ogr {
         return false;
     }
 
+    std::vector<VertexPtr> OpticalGraphRecognition::GetVertexesInLocalityOrder() const {
+        std::vector<std::pair<uint64_t, VertexPtr>> keyed_vertexes;
+        for (const auto& [_, vertex] : vertexes_) {
+            uint64_t row_sum = 0;
+            uint64_t column_sum = 0;
+            for (const point::Point& point : vertex->points) {
+                row_sum += point.row;
+                column_sum += point.column;
+            }
+
+            const uint64_t size = std::max<uint64_t>(vertex->points.size(), 1);
+            const uint64_t key = utils::MortonCode(row_sum / size, column_sum / size);
+            keyed_vertexes.emplace_back(key, vertex);
+        }
+
+        std::sort(keyed_vertexes.begin(), keyed_vertexes.end(), [](const auto& lhs, const auto& rhs) {
+            return std::make_pair(lhs.first, lhs.second->id) < std::make_pair(rhs.first, rhs.second->id);
+        });
+
+        std::vector<VertexPtr> ordered_vertexes;
+        for (auto& [_, vertex] : keyed_vertexes) {
+            ordered_vertexes.push_back(std::move(vertex));
+        }
+
+        return ordered_vertexes;
+    }
+
     std::vector<EdgeId> OpticalGraphRecognition::GetEdgesIds() {
         std::vector<EdgeId> ids;
 
@@ -391,144 +603,24 @@ namespace ogr {
         return ids;
     }
 
-    tabulate::Table OpticalGraphRecognition::GetGeneralData(const std::string &title) {
-        using namespace tabulate;
-        using Row_t = Table::Row_t;
-
-        Table results;
-        results.add_row({title});
-
-        Table general_info;
-        general_info.format().hide_border();
-        general_info.add_row({"Filename", filename_});
-        general_info.add_row({"Vertexes", std::to_string(vertexes_.size())});
-        general_info.add_row({"Edges", std::to_string(edges_.size())});
-        general_info.add_row({"Edge crossings", std::to_string(crossing_areas_.size())});
-
-        // TODO: remove crutch
-        general_info.add_row({"", ""});
-        general_info.add_row({"", ""});
-        general_info.add_row({"", ""});
-        general_info.add_row({"", ""});
-        general_info.add_row({"", ""});
-        general_info.add_row({"", ""});
-        general_info.add_row({"", ""});
-        general_info.add_row({"", ""});
-
-        results.add_row(Row_t{general_info});
-
-        return results;
-    }
-
-    tabulate::Table OpticalGraphRecognition::GetExtendedGeneralData(const std::string &title, OpticalGraphRecognition& baseline) {
-        using namespace tabulate;
-        using Row_t = Table::Row_t;
-
-        auto to_sting_diff = [](auto x) {
-            if (x > 0) {
-                return std::string{"+"} + std::to_string(std::lround(x));
-            }
-
-            return std::to_string(std::lround(x));
-        };
-
-        auto calculate_diff_ratio = [](double x, double y) {
-            return (x - y) / y;
-        };
-
-        Table results;
-        results.add_row({title});
-
-        Table general_info;
-        general_info.format().hide_border();
-        general_info.add_row({"Filename", filename_});
-        general_info.add_row({"Vertexes", std::to_string(vertexes_.size())});
-        general_info.add_row({"Edges", std::to_string(edges_.size())});
-        general_info.add_row({"Edge crossings", std::to_string(crossing_areas_.size())});
-
-        const size_t bundled_pairs = bundling_map_.Size() - edges_.size();
-        const size_t unique_edge_pairs_cnt = (edges_.size() * (edges_.size() - 1)) / 2;
-        general_info.add_row({"Bundled edge pairs", std::to_string(bundled_pairs)});
-
-        const double bundling_ratio = static_cast<double>(bundled_pairs) / unique_edge_pairs_cnt;
-        general_info.add_row({"Bundling ratio", std::to_string(std::lround(bundling_ratio * 100)) + "%"});
+    void OpticalGraphRecognition::FillSnapshot(snapshot::SnapshotWriter& writer) const {
+        writer.SetFilename(filename_);
+        writer.SetStats(inc_usage_, beam_width_, pruned_crawlers_, edge_stats_);
 
-        const double edge_len_diff = calculate_diff_ratio(edge_stats_.mean, baseline.edge_stats_.mean);
-        general_info.add_row({"Edge len mean", to_sting_diff(edge_len_diff * 100) + "%"});
-
-        const double edge_var_diff = calculate_diff_ratio(edge_stats_.var, baseline.edge_stats_.var);
-        general_info.add_row({"Edge len var", to_sting_diff(edge_var_diff * 100) + "%"});
-
-        const double edge_crossings_diff = calculate_diff_ratio(crossing_areas_.size(), baseline.crossing_areas_.size());
-        general_info.add_row({"Crossings", to_sting_diff(edge_crossings_diff * 100) + "%"});
-
-        const double inc_diff = calculate_diff_ratio(inc_usage_, baseline.inc_usage_);
-        general_info.add_row({"Inc", to_sting_diff(inc_diff * 100) + "%"});
-
-        size_t false_positive_connections = 0;
-        for (const auto& [vid1, v1] : baseline.vertexes_) {
-            for (const auto& [vid2, v2] : baseline.vertexes_) {
-                if (vid1 == vid2) {
-                    continue;
-                }
-
-                if (adjacency_map_.Contains(vid1, vid2) && !baseline.adjacency_map_.Contains(vid1, vid2)) {
-                    false_positive_connections++;
-                }
-            }
+        for (const auto& [vid, vertex] : vertexes_) {
+            writer.AddVertex(vid, vertex->points);
         }
-        false_positive_connections /= 2;
-        general_info.add_row({"FP connections", std::to_string(false_positive_connections)});
-
-        const double ambiguity = static_cast<double>(false_positive_connections) / edges_.size();
-        general_info.add_row({"Ambiguity", std::to_string(std::lround(ambiguity * 100)) + "%"});
-
-        results.add_row(Row_t{general_info});
-
-        return results;
-    }
-
-    tabulate::Table OpticalGraphRecognition::GetEdgesInfo(const std::string &title, OpticalGraphRecognition& baseline) {
-        using namespace tabulate;
-        static constexpr size_t kLimitBundlingOutput = 7;
 
-        Table edges;
-        edges.add_row({"Edge ID", "Source", "Sink", "Edge length", "Type", "Bundled with"});
-
-        auto edges_ids = GetEdgesIds();
-        for (EdgeId edge_id : edges_ids) {
-            const EdgePtr& edge = edges_[edge_id];
-            std::stringstream ss;
-
-            size_t counter = 0;
-            for (EdgeId j : edges_ids) {
-                if (bundling_map_.Contains(edge_id, j) && j != edge_id) {
-                    if (++counter >= kLimitBundlingOutput) {
-                        ss << "..." << ", ";
-                        break;
-                    }
-
-                    ss << j << ", ";
-                }
-            }
-
-            std::string s_string = ss.str();
-            if (!s_string.empty()) {
-                s_string.resize(s_string.size() - 2);
-            }
-
-            const bool false_positive_edge = !baseline.adjacency_map_.Contains(edge->v1, edge->v2);
+        for (const auto& [eid, edge] : edges_) {
+            writer.AddEdge(*edge, edge_lengths_.Get(eid, eid));
+        }
 
-            edges.add_row({
-                  std::to_string(edge_id),
-                  std::to_string(edge->v1),
-                  std::to_string(edge->v2),
-                  std::to_string(edge_lengths_(edge_id, edge_id)),
-                  false_positive_edge ? "FP" : "TP",
-                  s_string
-            });
+        for (const auto& [crossing_id, points] : crossing_areas_) {
+            writer.AddCrossing(crossing_id, points);
         }
 
-        return edges;
+        for (const auto& [key, _] : bundling_map_) {
+            writer.AddBundlingPair(std::get<0>(key), std::get<1>(key));
+        }
     }
 }
@@ -1,6 +1,11 @@
 #pragma once
 
 #include <ogr_components/matrix.h>
+#include <ogr_components/structured_elements.h>
+#include <ogr_components/skeleton_index.h>
+#include <ogr_components/preprocessed_graph.h>
+#include <ogr_components/ingestion.h>
+#include <crawler/edges_detector.h>
 #include <iterators/consecutive_iterator.h>
 #include <vertex/detectors.h>
 #include <utils/debug.h>
@@ -8,14 +13,18 @@
 #include <stats/stats.h>
 
 #include <opencv2/opencv.hpp>
-#include <tabulate/table.hpp>
 
+#include <memory>
 #include <unordered_map>
 #include <optional>
 #include <filesystem>
 
 
 namespace ogr {
+    namespace snapshot {
+        class SnapshotWriter;
+    }
+
     namespace map {
         // Composite key generator for bundling edges map
         template <>
@@ -26,12 +35,38 @@ namespace ogr {
 
     class OpticalGraphRecognition {
     public:
-        explicit OpticalGraphRecognition(const cv::Mat& source_graph, const std::string& filename = "");
-
-        void UpdateIncUsage(const cv::Mat& source_image);
-
-        void DetectVertexes(std::function<bool(point::PointPtr)> is_vertex);
-        void DetectEdges(std::optional<VertexId> vertex_id = std::nullopt);
+        /** Recognition with vertexes detected from vertex mask of ingested image */
+        explicit OpticalGraphRecognition(
+                IngestedImage image,
+                const std::string& filename = "",
+                const matrix::GridOptions& grid_options = {});
+
+        /** Restore recognition with detected vertexes from preprocessing result (e.g. cached one) */
+        explicit OpticalGraphRecognition(
+                const PreprocessedGraph& graph,
+                const std::string& filename = "",
+                const matrix::GridOptions& grid_options = {});
+
+        /**
+         * Copy with own point states: points of copied vertexes, edges and crossings refer to copied matrix,
+         * so recognition can be continued from copied state independently (e.g. with other params).
+         * Static skeleton and points map are shared, so copy costs point states of skeleton, not of whole image
+         */
+        OpticalGraphRecognition(const OpticalGraphRecognition& other);
+        OpticalGraphRecognition(OpticalGraphRecognition&&) = default;
+        OpticalGraphRecognition& operator=(const OpticalGraphRecognition&) = delete;
+        OpticalGraphRecognition& operator=(OpticalGraphRecognition&&) = default;
+
+        /** Preprocessing result, it's valid until edges are detected. Graph refers to given storages */
+        PreprocessedGraph GetPreprocessedGraph(std::vector<uint64_t>& skeleton_bits, std::vector<VertexPixel>& vertex_pixels) const;
+
+        void DetectEdges(
+                const AlgoParams& params,
+                std::optional<VertexId> vertex_id = std::nullopt,
+                bool locality_order = false,
+                size_t threads = 1,
+                size_t beam_width = 0,
+                const crawler::CrawlerSizes& crawler_sizes = {});
 
         void UnionFoundEdges();
         void IntersectFoundEdges();
@@ -39,36 +74,41 @@ namespace ogr {
         void MarkCrossingsPoints();
 
         void DumpResultImages(const std::filesystem::path& output_dir, bool dump_edges, std::optional<VertexId> vertex = std::nullopt);
-        tabulate::Table GetGeneralData(const std::string& title);
-        tabulate::Table GetExtendedGeneralData(const std::string& title, OpticalGraphRecognition& baseline);
-        tabulate::Table GetEdgesInfo(const std::string& title, OpticalGraphRecognition& baseline);
+
+        /** Finished recognition data for snapshot, whole report is made from snapshots */
+        void FillSnapshot(snapshot::SnapshotWriter& writer) const;
 
     private:
+        // Skeleton and points map of matrix are static, so they are shared by copies of recognition
+        std::shared_ptr<const matrix::SkeletonIndex> skeleton_;
         matrix::GraphRecognitionMatrix grm_;
         std::unordered_map<VertexId, VertexPtr> vertexes_;
         std::unordered_map<EdgeId, EdgePtr> edges_;
-        std::unordered_map<uint64_t, std::vector<point::PointPtr>> crossing_areas_;
+        std::unordered_map<uint64_t, std::vector<point::Point>> crossing_areas_;
 
         map::CompositeMap<bool, EdgeId, EdgeId> bundling_map_;
         map::CompositeMap<size_t, EdgeId, EdgeId> edge_lengths_;
-        map::CompositeMap<EdgeId, VertexId, VertexId> adjacency_map_;
 
         size_t inc_usage_{0};
+        size_t beam_width_{0};
+        size_t pruned_crawlers_{0};
         stats::Stats edge_stats_;
         std::string filename_;
 
     private:
+        void DetectVertexes(const std::vector<uint8_t>& vertex_mask);
         void DetectPortPoints();
         void PostProcessEdges(bool intersect);
         void ClearGrmFromUnusedEdgePoints();
         void CalculateEdgesLength();
-        bool IsCrossingPoint(const point::EdgePointPtr&);
+        bool IsCrossingPoint(const point::Point&);
         std::vector<EdgeId> GetEdgesIds();
+        std::vector<VertexPtr> GetVertexesInLocalityOrder() const;
 
     private:
         void ProcessSingleEdgeLength(EdgePtr edge);
 
     private:
-        static EdgePtr ChooseBestEdge(EdgePtr e1, EdgePtr e2);
+        EdgePtr ChooseBestEdge(EdgePtr e1, EdgePtr e2);
     };
 }
@@ -3,10 +3,150 @@
 #include <tabulate/table.hpp>
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <sstream>
 
 namespace ogr {
-    void MakeReport(OgrAlgo& baseline, std::vector<OgrAlgo> algos) {
+    namespace {
+        tabulate::Table GetGeneralData(const Snapshot& algo, const std::string& title) {
+            using namespace tabulate;
+            using Row_t = Table::Row_t;
+
+            Table results;
+            results.add_row({title});
+
+            Table general_info;
+            general_info.format().hide_border();
+            general_info.add_row({"Filename", std::string{algo.Filename()}});
+            general_info.add_row({"Vertexes", std::to_string(algo.Vertexes().size())});
+            general_info.add_row({"Edges", std::to_string(algo.Edges().size())});
+            general_info.add_row({"Edge crossings", std::to_string(algo.Crossings().size())});
+            if (algo.BeamWidth()) {
+                general_info.add_row({"Pruned crawlers", std::to_string(algo.PrunedCrawlers())});
+            }
+
+            // TODO: remove crutch
+            general_info.add_row({"", ""});
+            general_info.add_row({"", ""});
+            general_info.add_row({"", ""});
+            general_info.add_row({"", ""});
+            general_info.add_row({"", ""});
+            general_info.add_row({"", ""});
+            general_info.add_row({"", ""});
+            general_info.add_row({"", ""});
+
+            results.add_row(Row_t{general_info});
+
+            return results;
+        }
+
+        tabulate::Table GetExtendedGeneralData(const Snapshot& algo, const std::string& title, const Snapshot& baseline) {
+            using namespace tabulate;
+            using Row_t = Table::Row_t;
+
+            auto to_sting_diff = [](auto x) {
+                if (x > 0) {
+                    return std::string{"+"} + std::to_string(std::lround(x));
+                }
+
+                return std::to_string(std::lround(x));
+            };
+
+            auto calculate_diff_ratio = [](double x, double y) {
+                return (x - y) / y;
+            };
+
+            const size_t edges_count = algo.Edges().size();
+
+            Table results;
+            results.add_row({title});
+
+            Table general_info;
+            general_info.format().hide_border();
+            general_info.add_row({"Filename", std::string{algo.Filename()}});
+            general_info.add_row({"Vertexes", std::to_string(algo.Vertexes().size())});
+            general_info.add_row({"Edges", std::to_string(edges_count)});
+            general_info.add_row({"Edge crossings", std::to_string(algo.Crossings().size())});
+            if (algo.BeamWidth()) {
+                general_info.add_row({"Pruned crawlers", std::to_string(algo.PrunedCrawlers())});
+            }
+
+            // Bundling pairs include pairs of same edge
+            const size_t bundled_pairs = algo.BundlingPairs().size() - edges_count;
+            const size_t unique_edge_pairs_cnt = (edges_count * (edges_count - 1)) / 2;
+            general_info.add_row({"Bundled edge pairs", std::to_string(bundled_pairs)});
+
+            const double bundling_ratio = static_cast<double>(bundled_pairs) / unique_edge_pairs_cnt;
+            general_info.add_row({"Bundling ratio", std::to_string(std::lround(bundling_ratio * 100)) + "%"});
+
+            const double edge_len_diff = calculate_diff_ratio(algo.EdgeLengthStats().mean, baseline.EdgeLengthStats().mean);
+            general_info.add_row({"Edge len mean", to_sting_diff(edge_len_diff * 100) + "%"});
+
+            const double edge_var_diff = calculate_diff_ratio(algo.EdgeLengthStats().var, baseline.EdgeLengthStats().var);
+            general_info.add_row({"Edge len var", to_sting_diff(edge_var_diff * 100) + "%"});
+
+            const double edge_crossings_diff = calculate_diff_ratio(algo.Crossings().size(), baseline.Crossings().size());
+            general_info.add_row({"Crossings", to_sting_diff(edge_crossings_diff * 100) + "%"});
+
+            const double inc_diff = calculate_diff_ratio(algo.IncUsage(), baseline.IncUsage());
+            general_info.add_row({"Inc", to_sting_diff(inc_diff * 100) + "%"});
+
+            const size_t false_positive_connections = CountFalsePositiveConnections(algo, baseline);
+            general_info.add_row({"FP connections", std::to_string(false_positive_connections)});
+
+            const double ambiguity = static_cast<double>(false_positive_connections) / edges_count;
+            general_info.add_row({"Ambiguity", std::to_string(std::lround(ambiguity * 100)) + "%"});
+
+            results.add_row(Row_t{general_info});
+
+            return results;
+        }
+
+        tabulate::Table GetEdgesInfo(const Snapshot& algo, const std::string& title, const Snapshot& baseline) {
+            using namespace tabulate;
+            static constexpr size_t kLimitBundlingOutput = 7;
+
+            Table edges;
+            edges.add_row({"Edge ID", "Source", "Sink", "Edge length", "Type", "Bundled with"});
+
+            for (const snapshot::SnapshotEdge& edge : algo.Edges()) {
+                std::stringstream ss;
+
+                size_t counter = 0;
+                for (const snapshot::SnapshotEdge& other : algo.Edges()) {
+                    if (algo.IsBundled(edge.id, other.id) && other.id != edge.id) {
+                        if (++counter >= kLimitBundlingOutput) {
+                            ss << "..." << ", ";
+                            break;
+                        }
+
+                        ss << other.id << ", ";
+                    }
+                }
+
+                std::string s_string = ss.str();
+                if (!s_string.empty()) {
+                    s_string.resize(s_string.size() - 2);
+                }
+
+                const bool false_positive_edge = !baseline.IsAdjacent(edge.v1, edge.v2);
+
+                edges.add_row({
+                      std::to_string(edge.id),
+                      std::to_string(edge.v1),
+                      std::to_string(edge.v2),
+                      std::to_string(edge.length),
+                      false_positive_edge ? "FP" : "TP",
+                      s_string
+                });
+            }
+
+            return edges;
+        }
+    }
+
+    void MakeReport(const Snapshot& baseline, const std::vector<Snapshot>& algos) {
         using namespace tabulate;
         using Row_t = Table::Row_t;
 
@@ -20,10 +160,10 @@ namespace ogr {
                 .font_align(FontAlign::center);
 
         std::vector<Row_t::value_type> general_algo_infos;
-        general_algo_infos.emplace_back(baseline.GetGeneralData("Baseline algo"));
+        general_algo_infos.emplace_back(GetGeneralData(baseline, "Baseline algo"));
         for (size_t i = 0; i < algos.size(); ++i) {
             const std::string title = std::string{"Bundling algo "} + std::to_string(i + 1);
-            general_algo_infos.emplace_back(algos[i].GetExtendedGeneralData(title, baseline));
+            general_algo_infos.emplace_back(GetExtendedGeneralData(algos[i], title, baseline));
         }
 
         results.add_row({"Algorithms visualization comparison"});
@@ -40,10 +180,138 @@ namespace ogr {
             ss << "Edges info for algo " << (i + 1);
             results.add_row({ss.str()});
             results[3 + i * 2].format().hide_border_bottom().font_color(Color::cyan).font_style({FontStyle::italic});
-            results.add_row(Row_t{algos[i].GetEdgesInfo(ss.str(), baseline)});
+            results.add_row(Row_t{GetEdgesInfo(algos[i], ss.str(), baseline)});
             results[3 + i * 2 + 1].format().hide_border_top();
         }
 
         std::cout << results << std::endl;
     }
+
+    double GetEdgeRecall(const Snapshot& algo, const Snapshot& reference) {
+        size_t reference_connections = 0;
+        size_t found_connections = 0;
+        for (const snapshot::IdPair& pair : reference.AdjacencyPairs()) {
+            if (pair.first == pair.second || !reference.ContainsVertex(pair.first) || !reference.ContainsVertex(pair.second)) {
+                continue;
+            }
+
+            reference_connections++;
+            if (algo.IsAdjacent(pair.first, pair.second)) {
+                found_connections++;
+            }
+        }
+
+        if (!reference_connections) {
+            return 1.0;
+        }
+
+        return static_cast<double>(found_connections) / reference_connections;
+    }
+
+    size_t CountFalsePositiveConnections(const Snapshot& algo, const Snapshot& baseline) {
+        size_t false_positive_connections = 0;
+        for (const snapshot::IdPair& pair : algo.AdjacencyPairs()) {
+            if (pair.first == pair.second || !baseline.ContainsVertex(pair.first) || !baseline.ContainsVertex(pair.second)) {
+                continue;
+            }
+
+            if (!baseline.IsAdjacent(pair.first, pair.second)) {
+                false_positive_connections++;
+            }
+        }
+
+        return false_positive_connections;
+    }
+
+    void MakeBenchmarkReport(const std::vector<BenchmarkRecord>& records) {
+        using namespace tabulate;
+
+        Table results;
+        results.add_row({"Crawler sizes benchmark"}).format()
+                .font_color(Color::green)
+                .font_style({FontStyle::bold})
+                .font_align(FontAlign::center);
+
+        Table runs;
+        runs.add_row({"Filename", "Step size", "Sub path steps", "Time, ms", "Edge recall"});
+        for (const BenchmarkRecord& record : records) {
+            runs.add_row({
+                record.filename,
+                std::to_string(record.crawler_sizes.step_size),
+                std::to_string(record.crawler_sizes.sub_path_steps_size),
+                std::to_string(std::lround(record.time_ms)),
+                std::to_string(std::lround(record.edge_recall * 100)) + "%"
+            });
+        }
+        results.add_row(Table::Row_t{runs});
+
+        std::cout << results << std::endl;
+    }
+
+    void MakeSweepReport(const std::string& filename, const std::vector<SweepRecord>& records) {
+        using namespace tabulate;
+
+        Table results;
+        results.add_row({"Params sweep of " + filename}).format()
+                .font_color(Color::green)
+                .font_style({FontStyle::bold})
+                .font_align(FontAlign::center);
+
+        auto to_string = [](const double value) {
+            std::stringstream ss;
+            ss << value;
+            return ss.str();
+        };
+
+        Table runs;
+        runs.add_row({"Curvature", "Stable diff", "State diff", "Edges", "FP connections", "Crossings", "Time, ms"});
+        for (const SweepRecord& record : records) {
+            runs.add_row({
+                to_string(record.curvature),
+                to_string(record.stable_diff),
+                to_string(record.state_diff),
+                std::to_string(record.edges),
+                std::to_string(record.false_positive_connections),
+                std::to_string(record.crossings),
+                std::to_string(std::lround(record.time_ms))
+            });
+        }
+        results.add_row(Table::Row_t{runs});
+
+        std::cout << results << std::endl;
+    }
+
+    void MakePipelineReport(const std::vector<PipelineStageRecord>& records) {
+        using namespace tabulate;
+
+        Table results;
+        results.add_row({"Images pipeline"}).format()
+                .font_color(Color::green)
+                .font_style({FontStyle::bold})
+                .font_align(FontAlign::center);
+
+        Table stages;
+        stages.add_row({"Stage", "Workers", "Images", "Busy, ms", "Utilisation", "Input wait, ms", "Output wait, ms", "Output queue"});
+        for (const PipelineStageRecord& record : records) {
+            const double capacity_ms = record.wall_ms * static_cast<double>(record.workers);
+            const double utilisation = capacity_ms > 0 ? record.busy_ms / capacity_ms : 0;
+            const std::string output_queue = record.output_queue_capacity
+                    ? std::to_string(record.output_queue_max_size) + "/" + std::to_string(record.output_queue_capacity)
+                    : "-";
+
+            stages.add_row({
+                record.name,
+                std::to_string(record.workers),
+                std::to_string(record.images),
+                std::to_string(std::lround(record.busy_ms)),
+                std::to_string(std::lround(utilisation * 100)) + "%",
+                std::to_string(std::lround(record.input_wait_ms)),
+                std::to_string(std::lround(record.output_wait_ms)),
+                output_queue
+            });
+        }
+        results.add_row(Table::Row_t{stages});
+
+        std::cout << results << std::endl;
+    }
 }
@@ -1,9 +1,56 @@
 #pragma once
 
 #include <optical_graph_recognition.h>
+#include <snapshot/snapshot.h>
 
 namespace ogr {
-    using OgrAlgo = OpticalGraphRecognition;
+    using snapshot::Snapshot;
 
-    void MakeReport(OgrAlgo& baseline, std::vector<OgrAlgo> algos);
+    /** Report is made purely from snapshots of recognitions */
+    void MakeReport(const Snapshot& baseline, const std::vector<Snapshot>& algos);
+
+    /** Share of vertexes connections of reference recognition which are found in algo one */
+    double GetEdgeRecall(const Snapshot& algo, const Snapshot& reference);
+
+    /** Vertexes connections which are absent in baseline */
+    size_t CountFalsePositiveConnections(const Snapshot& algo, const Snapshot& baseline);
+
+    /** Run of single image with particular crawler sizes */
+    struct BenchmarkRecord {
+        std::string filename;
+        crawler::CrawlerSizes crawler_sizes;
+        double time_ms;
+        double edge_recall;
+    };
+
+    void MakeBenchmarkReport(const std::vector<BenchmarkRecord>& records);
+
+    /** Recognition of single image with particular combination of angle thresholds */
+    struct SweepRecord {
+        double curvature;
+        double stable_diff;
+        double state_diff;
+        size_t edges;
+        size_t false_positive_connections;
+        size_t crossings;
+        double time_ms;
+    };
+
+    void MakeSweepReport(const std::string& filename, const std::vector<SweepRecord>& records);
+
+    /** Work of single stage of images pipeline */
+    struct PipelineStageRecord {
+        std::string name;
+        size_t workers;
+        size_t images;
+        double busy_ms;
+        double wall_ms;
+        // Time workers waited for input (starvation) and for room in output queue (back-pressure)
+        double input_wait_ms;
+        double output_wait_ms;
+        size_t output_queue_capacity;
+        size_t output_queue_max_size;
+    };
+
+    void MakePipelineReport(const std::vector<PipelineStageRecord>& records);
 }
@@ -0,0 +1,321 @@
+#include "snapshot.h"
+
+#include <optical_graph_recognition.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+
+namespace ogr::snapshot {
+    namespace {
+        constexpr char kMagic[8] = {'O', 'G', 'R', 'S', 'N', 'A', 'P', '\0'};
+        // Version 2: inc usage is count of ink pixels
+        constexpr uint32_t kFormatVersion = 2;
+        constexpr size_t kSectionAlignment = 8;
+
+        static_assert(sizeof(Header) % kSectionAlignment == 0);
+
+        IdPair MakePair(const uint64_t id1, const uint64_t id2) {
+            return IdPair{.first = std::min(id1, id2), .second = std::max(id1, id2)};
+        }
+
+        template <typename T>
+        void AppendSection(std::vector<uint8_t>& buffer, Section& section, std::span<const T> items) {
+            buffer.resize((buffer.size() + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment);
+            section = Section{.offset = buffer.size(), .count = items.size()};
+
+            const auto* bytes = reinterpret_cast<const uint8_t*>(items.data());
+            buffer.insert(buffer.end(), bytes, bytes + items.size_bytes());
+        }
+
+        /** File is written aside and renamed, so readers never see partially written one */
+        void WriteFile(const std::filesystem::path& path, const uint8_t* data, const size_t size) {
+            std::filesystem::path tmp_path = path;
+            tmp_path += ".tmp" + std::to_string(::getpid()) + "-" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+            {
+                std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+                out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+                if (!out) {
+                    throw std::runtime_error{"Failed to write snapshot " + path.string()};
+                }
+            }
+
+            std::filesystem::rename(tmp_path, path);
+        }
+
+        template <typename T>
+        bool IsSortedById(std::span<const T> items) {
+            return std::is_sorted(items.begin(), items.end(), [](const T& lhs, const T& rhs) {
+                return lhs.id < rhs.id;
+            });
+        }
+    }
+
+    void SnapshotWriter::SetFilename(std::string_view filename) {
+        filename_ = filename;
+    }
+
+    void SnapshotWriter::SetStats(
+            const uint64_t inc_usage,
+            const uint64_t beam_width,
+            const uint64_t pruned_crawlers,
+            const stats::Stats& edge_length_stats
+    ) {
+        header_.inc_usage = inc_usage;
+        header_.beam_width = beam_width;
+        header_.pruned_crawlers = pruned_crawlers;
+        header_.edge_length_mean = edge_length_stats.mean;
+        header_.edge_length_var = edge_length_stats.var;
+    }
+
+    void SnapshotWriter::AddVertex(const VertexId id, const std::vector<point::Point>& points) {
+        vertexes_.push_back(SnapshotVertex{
+            .id = id,
+            .pixels_offset = static_cast<uint32_t>(vertex_pixels_.size()),
+            .pixels_count = static_cast<uint32_t>(points.size())
+        });
+
+        for (const point::Point& point : points) {
+            vertex_pixels_.push_back(Pixel{.row = point.row, .column = point.column});
+        }
+    }
+
+    void SnapshotWriter::AddEdge(const Edge& edge, const uint64_t length) {
+        const size_t runs_offset = edge_runs_.size();
+        for (const point::Point& point : edge.points) {
+            if (edge_runs_.size() > runs_offset) {
+                PixelRun& run = edge_runs_.back();
+                if (run.row == point.row && run.column + run.length == point.column) {
+                    ++run.length;
+                    continue;
+                }
+            }
+
+            edge_runs_.push_back(PixelRun{.row = point.row, .column = point.column, .length = 1});
+        }
+
+        edges_.push_back(SnapshotEdge{
+            .id = edge.id,
+            .v1 = edge.v1,
+            .v2 = edge.v2,
+            .irregularity = edge.irregularity,
+            .length = length,
+            .runs_offset = static_cast<uint32_t>(runs_offset),
+            .runs_count = static_cast<uint32_t>(edge_runs_.size() - runs_offset)
+        });
+    }
+
+    void SnapshotWriter::AddCrossing(const uint64_t id, const std::vector<point::Point>& points) {
+        crossings_.push_back(SnapshotCrossing{
+            .id = id,
+            .pixels_offset = static_cast<uint32_t>(crossing_pixels_.size()),
+            .pixels_count = static_cast<uint32_t>(points.size())
+        });
+
+        for (const point::Point& point : points) {
+            crossing_pixels_.push_back(Pixel{.row = point.row, .column = point.column});
+        }
+    }
+
+    void SnapshotWriter::AddBundlingPair(const EdgeId e1, const EdgeId e2) {
+        bundling_pairs_.push_back(MakePair(e1, e2));
+    }
+
+    std::vector<uint8_t> SnapshotWriter::Serialize() const {
+        auto by_id = [](const auto& lhs, const auto& rhs) {
+            return lhs.id < rhs.id;
+        };
+
+        std::vector<SnapshotVertex> vertexes = vertexes_;
+        std::sort(vertexes.begin(), vertexes.end(), by_id);
+
+        std::vector<SnapshotEdge> edges = edges_;
+        std::sort(edges.begin(), edges.end(), by_id);
+
+        std::vector<SnapshotCrossing> crossings = crossings_;
+        std::sort(crossings.begin(), crossings.end(), by_id);
+
+        std::vector<IdPair> bundling_pairs = bundling_pairs_;
+        std::sort(bundling_pairs.begin(), bundling_pairs.end());
+        bundling_pairs.erase(std::unique(bundling_pairs.begin(), bundling_pairs.end()), bundling_pairs.end());
+
+        // Vertexes are connected if there is edge between them
+        std::vector<IdPair> adjacency_pairs;
+        for (const SnapshotEdge& edge : edges) {
+            adjacency_pairs.push_back(MakePair(edge.v1, edge.v2));
+        }
+        std::sort(adjacency_pairs.begin(), adjacency_pairs.end());
+        adjacency_pairs.erase(std::unique(adjacency_pairs.begin(), adjacency_pairs.end()), adjacency_pairs.end());
+
+        Header header = header_;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kFormatVersion;
+
+        std::vector<uint8_t> buffer(sizeof(Header));
+        AppendSection(buffer, header.filename, std::span<const char>(filename_));
+        AppendSection(buffer, header.vertexes, std::span<const SnapshotVertex>(vertexes));
+        AppendSection(buffer, header.vertex_pixels, std::span<const Pixel>(vertex_pixels_));
+        AppendSection(buffer, header.edges, std::span<const SnapshotEdge>(edges));
+        AppendSection(buffer, header.edge_runs, std::span<const PixelRun>(edge_runs_));
+        AppendSection(buffer, header.crossings, std::span<const SnapshotCrossing>(crossings));
+        AppendSection(buffer, header.crossing_pixels, std::span<const Pixel>(crossing_pixels_));
+        AppendSection(buffer, header.bundling_pairs, std::span<const IdPair>(bundling_pairs));
+        AppendSection(buffer, header.adjacency_pairs, std::span<const IdPair>(adjacency_pairs));
+
+        std::memcpy(buffer.data(), &header, sizeof(header));
+
+        return buffer;
+    }
+
+    void SnapshotWriter::Write(const std::filesystem::path& path) const {
+        const std::vector<uint8_t> buffer = Serialize();
+        WriteFile(path, buffer.data(), buffer.size());
+    }
+
+    Snapshot::Snapshot(std::unique_ptr<utils::MappedFile> file, std::vector<uint8_t> buffer)
+        : file_(std::move(file))
+        , buffer_(std::move(buffer)) {
+        data_ = file_ ? file_->Data() : buffer_.data();
+        size_ = file_ ? file_->Size() : buffer_.size();
+
+        if (!data_ || size_ < sizeof(Header)) {
+            throw std::runtime_error{"Snapshot is truncated"};
+        }
+
+        std::memcpy(&header_, data_, sizeof(header_));
+        Validate();
+    }
+
+    Snapshot Snapshot::Open(const std::filesystem::path& path) {
+        auto file = std::make_unique<utils::MappedFile>(path);
+        if (!file->Data()) {
+            throw std::runtime_error{"Can't map snapshot " + path.string()};
+        }
+
+        return Snapshot(std::move(file), {});
+    }
+
+    Snapshot Snapshot::FromBuffer(std::vector<uint8_t> buffer) {
+        return Snapshot(nullptr, std::move(buffer));
+    }
+
+    void Snapshot::Write(const std::filesystem::path& path) const {
+        WriteFile(path, data_, size_);
+    }
+
+    void Snapshot::Validate() const {
+        if (std::memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0) {
+            throw std::runtime_error{"Not a snapshot"};
+        }
+
+        if (header_.version != kFormatVersion) {
+            throw std::runtime_error{"Unsupported snapshot version " + std::to_string(header_.version)};
+        }
+
+        auto check_section = [&](const Section& section, const size_t item_size) {
+            if (section.offset % kSectionAlignment || section.offset > size_ || section.count > (size_ - section.offset) / item_size) {
+                throw std::runtime_error{"Snapshot section is out of file"};
+            }
+        };
+
+        check_section(header_.filename, sizeof(char));
+        check_section(header_.vertexes, sizeof(SnapshotVertex));
+        check_section(header_.vertex_pixels, sizeof(Pixel));
+        check_section(header_.edges, sizeof(SnapshotEdge));
+        check_section(header_.edge_runs, sizeof(PixelRun));
+        check_section(header_.crossings, sizeof(SnapshotCrossing));
+        check_section(header_.crossing_pixels, sizeof(Pixel));
+        check_section(header_.bundling_pairs, sizeof(IdPair));
+        check_section(header_.adjacency_pairs, sizeof(IdPair));
+
+        auto check_range = [](const uint64_t offset, const uint64_t count, const uint64_t size) {
+            if (offset > size || count > size - offset) {
+                throw std::runtime_error{"Snapshot record refers out of section"};
+            }
+        };
+
+        for (const SnapshotVertex& vertex : Vertexes()) {
+            check_range(vertex.pixels_offset, vertex.pixels_count, header_.vertex_pixels.count);
+        }
+        for (const SnapshotEdge& edge : Edges()) {
+            check_range(edge.runs_offset, edge.runs_count, header_.edge_runs.count);
+        }
+        for (const SnapshotCrossing& crossing : Crossings()) {
+            check_range(crossing.pixels_offset, crossing.pixels_count, header_.crossing_pixels.count);
+        }
+
+        if (!IsSortedById(Vertexes()) || !IsSortedById(Edges()) || !IsSortedById(Crossings())
+                || !std::is_sorted(BundlingPairs().begin(), BundlingPairs().end())
+                || !std::is_sorted(AdjacencyPairs().begin(), AdjacencyPairs().end())) {
+            throw std::runtime_error{"Snapshot records are not sorted"};
+        }
+    }
+
+    std::string_view Snapshot::Filename() const {
+        const std::span<const char> filename = SectionView<char>(header_.filename);
+        return {filename.data(), filename.size()};
+    }
+
+    std::span<const SnapshotVertex> Snapshot::Vertexes() const {
+        return SectionView<SnapshotVertex>(header_.vertexes);
+    }
+
+    std::span<const SnapshotEdge> Snapshot::Edges() const {
+        return SectionView<SnapshotEdge>(header_.edges);
+    }
+
+    std::span<const SnapshotCrossing> Snapshot::Crossings() const {
+        return SectionView<SnapshotCrossing>(header_.crossings);
+    }
+
+    std::span<const Pixel> Snapshot::Pixels(const SnapshotVertex& vertex) const {
+        return SectionView<Pixel>(header_.vertex_pixels).subspan(vertex.pixels_offset, vertex.pixels_count);
+    }
+
+    std::span<const PixelRun> Snapshot::Runs(const SnapshotEdge& edge) const {
+        return SectionView<PixelRun>(header_.edge_runs).subspan(edge.runs_offset, edge.runs_count);
+    }
+
+    std::span<const Pixel> Snapshot::Pixels(const SnapshotCrossing& crossing) const {
+        return SectionView<Pixel>(header_.crossing_pixels).subspan(crossing.pixels_offset, crossing.pixels_count);
+    }
+
+    std::span<const IdPair> Snapshot::BundlingPairs() const {
+        return SectionView<IdPair>(header_.bundling_pairs);
+    }
+
+    std::span<const IdPair> Snapshot::AdjacencyPairs() const {
+        return SectionView<IdPair>(header_.adjacency_pairs);
+    }
+
+    bool Snapshot::ContainsVertex(const VertexId id) const {
+        const std::span<const SnapshotVertex> vertexes = Vertexes();
+        auto it = std::lower_bound(vertexes.begin(), vertexes.end(), id, [](const SnapshotVertex& vertex, const uint64_t id) {
+            return vertex.id < id;
+        });
+
+        return it != vertexes.end() && it->id == id;
+    }
+
+    bool Snapshot::IsBundled(const EdgeId e1, const EdgeId e2) const {
+        const std::span<const IdPair> pairs = BundlingPairs();
+        return std::binary_search(pairs.begin(), pairs.end(), MakePair(e1, e2));
+    }
+
+    bool Snapshot::IsAdjacent(const VertexId v1, const VertexId v2) const {
+        const std::span<const IdPair> pairs = AdjacencyPairs();
+        return std::binary_search(pairs.begin(), pairs.end(), MakePair(v1, v2));
+    }
+
+    Snapshot MakeSnapshot(const OpticalGraphRecognition& ogr_algo) {
+        SnapshotWriter writer;
+        ogr_algo.FillSnapshot(writer);
+        return Snapshot::FromBuffer(writer.Serialize());
+    }
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <ogr_components/structured_elements.h>
+#include <stats/stats.h>
+#include <utils/mapped_file.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ogr {
+    class OpticalGraphRecognition;
+}
+
+namespace ogr::snapshot {
+    /**
+     * Versioned binary format of finished recognition: header with sections table followed by sections,
+     * every section is array of trivial records aligned to 8 bytes.
+     * Records are sorted by ids, so snapshot is queried in place without parsing.
+     */
+    struct Section {
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    struct Pixel {
+        uint32_t row;
+        uint32_t column;
+    };
+
+    /** Consecutive pixels of edge path placed in one row from left to right */
+    struct PixelRun {
+        uint32_t row;
+        uint32_t column;
+        uint32_t length;
+    };
+
+    struct SnapshotVertex {
+        uint64_t id;
+        uint32_t pixels_offset;
+        uint32_t pixels_count;
+    };
+
+    struct SnapshotEdge {
+        uint64_t id;
+        uint64_t v1;
+        uint64_t v2;
+        double irregularity;
+        uint64_t length;
+        uint32_t runs_offset;
+        uint32_t runs_count;
+    };
+
+    struct SnapshotCrossing {
+        uint64_t id;
+        uint32_t pixels_offset;
+        uint32_t pixels_count;
+    };
+
+    /** Unordered pair of ids stored as first <= second */
+    struct IdPair {
+        uint64_t first;
+        uint64_t second;
+
+        auto operator<=>(const IdPair&) const = default;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+
+        uint64_t inc_usage;
+        uint64_t beam_width;
+        uint64_t pruned_crawlers;
+        double edge_length_mean;
+        double edge_length_var;
+
+        Section filename;
+        Section vertexes;
+        Section vertex_pixels;
+        Section edges;
+        Section edge_runs;
+        Section crossings;
+        Section crossing_pixels;
+        Section bundling_pairs;
+        Section adjacency_pairs;
+    };
+
+    /** Collects recognition data and serializes it into snapshot format */
+    class SnapshotWriter {
+    public:
+        void SetFilename(std::string_view filename);
+        void SetStats(uint64_t inc_usage, uint64_t beam_width, uint64_t pruned_crawlers, const stats::Stats& edge_length_stats);
+
+        void AddVertex(VertexId id, const std::vector<point::Point>& points);
+        void AddEdge(const Edge& edge, uint64_t length);
+        void AddCrossing(uint64_t id, const std::vector<point::Point>& points);
+        void AddBundlingPair(EdgeId e1, EdgeId e2);
+
+        std::vector<uint8_t> Serialize() const;
+
+        void Write(const std::filesystem::path& path) const;
+
+    private:
+        std::string filename_;
+        Header header_{};
+
+        std::vector<SnapshotVertex> vertexes_;
+        std::vector<Pixel> vertex_pixels_;
+        std::vector<SnapshotEdge> edges_;
+        std::vector<PixelRun> edge_runs_;
+        std::vector<SnapshotCrossing> crossings_;
+        std::vector<Pixel> crossing_pixels_;
+        std::vector<IdPair> bundling_pairs_;
+    };
+
+    /**
+     * Read-only view of snapshot, file snapshots are memory mapped and accessed without copying.
+     * Snapshot is validated on open, broken one throws.
+     */
+    class Snapshot {
+    public:
+        static Snapshot Open(const std::filesystem::path& path);
+        static Snapshot FromBuffer(std::vector<uint8_t> buffer);
+
+        Snapshot(Snapshot&&) = default;
+        Snapshot& operator=(Snapshot&&) = default;
+
+        void Write(const std::filesystem::path& path) const;
+
+        std::string_view Filename() const;
+
+        uint64_t IncUsage() const {
+            return header_.inc_usage;
+        }
+
+        uint64_t BeamWidth() const {
+            return header_.beam_width;
+        }
+
+        uint64_t PrunedCrawlers() const {
+            return header_.pruned_crawlers;
+        }
+
+        stats::Stats EdgeLengthStats() const {
+            return stats::Stats{.mean = header_.edge_length_mean, .var = header_.edge_length_var};
+        }
+
+        /** Records are sorted by ids */
+        std::span<const SnapshotVertex> Vertexes() const;
+        std::span<const SnapshotEdge> Edges() const;
+        std::span<const SnapshotCrossing> Crossings() const;
+
+        std::span<const Pixel> Pixels(const SnapshotVertex& vertex) const;
+        std::span<const PixelRun> Runs(const SnapshotEdge& edge) const;
+        std::span<const Pixel> Pixels(const SnapshotCrossing& crossing) const;
+
+        /** Pairs of bundled edges (pairs of same edge included) and pairs of connected vertexes, both sorted */
+        std::span<const IdPair> BundlingPairs() const;
+        std::span<const IdPair> AdjacencyPairs() const;
+
+        bool ContainsVertex(VertexId id) const;
+        bool IsBundled(EdgeId e1, EdgeId e2) const;
+        bool IsAdjacent(VertexId v1, VertexId v2) const;
+
+    private:
+        Snapshot(std::unique_ptr<utils::MappedFile> file, std::vector<uint8_t> buffer);
+
+        template <typename T>
+        std::span<const T> SectionView(const Section& section) const {
+            return {reinterpret_cast<const T*>(data_ + section.offset), section.count};
+        }
+
+        void Validate() const;
+
+    private:
+        // Snapshot data is owned either by mapping or by buffer
+        std::unique_ptr<utils::MappedFile> file_;
+        std::vector<uint8_t> buffer_;
+
+        const uint8_t* data_{nullptr};
+        size_t size_{0};
+        Header header_{};
+    };
+
+    Snapshot MakeSnapshot(const OpticalGraphRecognition& ogr_algo);
+}
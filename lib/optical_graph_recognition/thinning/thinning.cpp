@@ -0,0 +1,293 @@
+#include "thinning.h"
+
+#include <ogr_components/preprocessed_graph.h>
+
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <future>
+#include <memory>
+
+
+namespace ogr::thinning {
+    namespace {
+        // Rows of single pass taken by worker at once
+        constexpr size_t kChunkRows = 32;
+
+        /** Binary image packed to bits, rows are padded to whole words and padding bits are always zero */
+        struct BitImage {
+            size_t rows{0};
+            size_t columns{0};
+            size_t words_per_row{0};
+            std::vector<uint64_t> bits;
+
+            uint64_t* Row(const size_t row) {
+                return bits.data() + row * words_per_row;
+            }
+
+            const uint64_t* Row(const size_t row) const {
+                return bits.data() + row * words_per_row;
+            }
+        };
+
+        /** Calls func for rows in [begin, end), chunks of rows are distributed between workers of pool */
+        template <typename TFunc>
+        void ForEachRow(thread_pool* pool, const size_t threads, const size_t begin, const size_t end, TFunc&& func) {
+            if (!pool) {
+                for (size_t row = begin; row < end; ++row) {
+                    func(row);
+                }
+                return;
+            }
+
+            std::atomic<size_t> next_chunk{begin};
+            std::vector<std::future<void>> workers;
+            for (size_t i = 0; i < threads; ++i) {
+                workers.push_back(pool->submit([&]() {
+                    for (size_t chunk = next_chunk.fetch_add(kChunkRows); chunk < end; chunk = next_chunk.fetch_add(kChunkRows)) {
+                        for (size_t row = chunk; row < std::min(chunk + kChunkRows, end); ++row) {
+                            func(row);
+                        }
+                    }
+                }));
+            }
+
+            for (auto& worker : workers) {
+                worker.get();
+            }
+        }
+
+        BitImage Binarize(const cv::Mat& colored_image, thread_pool* pool, const size_t threads) {
+            if (colored_image.type() != CV_8UC3) {
+                throw std::runtime_error{"Thinning expects 8-bit BGR image"};
+            }
+
+            BitImage image{
+                .rows = static_cast<size_t>(colored_image.rows),
+                .columns = static_cast<size_t>(colored_image.cols),
+                .words_per_row = PreprocessedGraph::WordsPerRow(colored_image.cols)
+            };
+            image.bits.resize(image.rows * image.words_per_row, 0);
+
+            ForEachRow(pool, threads, 0, image.rows, [&](const size_t row) {
+                const cv::Vec3b* pixels = colored_image.ptr<cv::Vec3b>(static_cast<int>(row));
+                uint64_t* bits = image.Row(row);
+                for (size_t column = 0; column < image.columns; ++column) {
+                    bits[column >> 6] |= uint64_t{IsInk(pixels[column])} << (column & 63);
+                }
+            });
+
+            return image;
+        }
+
+        // Neighbours of 64 pixels of word: bit of column j is bit of column j + 1 (east) or j - 1 (west)
+        inline uint64_t East(const uint64_t word, const uint64_t next_word) {
+            return (word >> 1) | (next_word << 63);
+        }
+
+        inline uint64_t West(const uint64_t prev_word, const uint64_t word) {
+            return (word << 1) | (prev_word >> 63);
+        }
+
+        /** Bitwise "at least one" and "at least two" of values */
+        inline void CountUpToTwo(const std::array<uint64_t, 8>& values, uint64_t& at_least_one, uint64_t& at_least_two) {
+            at_least_one = 0;
+            at_least_two = 0;
+            for (const uint64_t value : values) {
+                at_least_two |= at_least_one & value;
+                at_least_one |= value;
+            }
+        }
+
+        /**
+         * Zhang-Suen sub-iteration for one row, conditions are evaluated for 64 pixels at once.
+         * Neighbours p2..p9 go clockwise from north, pixel is deleted if:
+         * 2 <= count(p) <= 6, p2..p9,p2 has single 01 transition and neither pair of opposite conditions holds.
+         * Returns true if any pixel of row is deleted.
+         */
+        template <size_t SubIteration>
+        bool ThinRow(
+                const uint64_t* up,
+                const uint64_t* row,
+                const uint64_t* down,
+                const uint64_t* interior,
+                uint64_t* result,
+                const size_t words
+        ) {
+            uint64_t deleted_any = 0;
+            for (size_t word = 0; word < words; ++word) {
+                const size_t prev = word ? word - 1 : word;
+                const size_t next = word + 1 < words ? word + 1 : word;
+                const uint64_t prev_mask = word ? ~uint64_t{0} : 0;
+                const uint64_t next_mask = word + 1 < words ? ~uint64_t{0} : 0;
+
+                const uint64_t p2 = up[word];
+                const uint64_t p3 = East(up[word], up[next] & next_mask);
+                const uint64_t p4 = East(row[word], row[next] & next_mask);
+                const uint64_t p5 = East(down[word], down[next] & next_mask);
+                const uint64_t p6 = down[word];
+                const uint64_t p7 = West(down[prev] & prev_mask, down[word]);
+                const uint64_t p8 = West(row[prev] & prev_mask, row[word]);
+                const uint64_t p9 = West(up[prev] & prev_mask, up[word]);
+
+                // Count of neighbours is in [2, 6]: at least two filled and at least two empty ones
+                uint64_t any_filled, two_filled;
+                CountUpToTwo({p2, p3, p4, p5, p6, p7, p8, p9}, any_filled, two_filled);
+                uint64_t any_empty, two_empty;
+                CountUpToTwo({~p2, ~p3, ~p4, ~p5, ~p6, ~p7, ~p8, ~p9}, any_empty, two_empty);
+
+                uint64_t any_transition, two_transitions;
+                CountUpToTwo({~p2 & p3, ~p3 & p4, ~p4 & p5, ~p5 & p6, ~p6 & p7, ~p7 & p8, ~p8 & p9, ~p9 & p2},
+                             any_transition, two_transitions);
+
+                const uint64_t opposite = SubIteration == 0
+                        ? (p2 & p4 & p6) | (p4 & p6 & p8)
+                        : (p2 & p4 & p8) | (p2 & p6 & p8);
+
+                const uint64_t deleted = row[word] & interior[word]
+                        & two_filled & two_empty
+                        & any_transition & ~two_transitions
+                        & ~opposite;
+
+                result[word] = row[word] & ~deleted;
+                deleted_any |= deleted;
+            }
+
+            return deleted_any != 0;
+        }
+
+        /**
+         * Zhang-Suen thinning (as cv::ximgproc::thinning): border pixels of image are never deleted,
+         * sub-iterations are repeated until whole iteration changes nothing.
+         *
+         * Sub-iteration reads one buffer and writes another, so rows are thinned independently.
+         * Row is skipped if it and its neighbour rows didn't change since previous sub-iteration of same kind:
+         * its result would be same, and other buffer already contains it.
+         */
+        void Thin(BitImage& image, thread_pool* pool, const size_t threads) {
+            if (image.rows < 3 || image.columns < 3) {
+                return;
+            }
+
+            const size_t words = image.words_per_row;
+            std::vector<uint64_t> interior(words, ~uint64_t{0});
+            interior[0] &= ~uint64_t{1};
+            interior[(image.columns - 1) >> 6] &= ~(uint64_t{1} << ((image.columns - 1) & 63));
+
+            BitImage other = image;
+            BitImage* source = &image;
+            BitImage* target = &other;
+
+            // Sub-iteration of last row change + 1, zero if row never changed
+            std::vector<size_t> changed_at(image.rows, 0);
+            std::vector<uint8_t> active(image.rows, 0);
+
+            for (size_t sub_iteration = 0;; ++sub_iteration) {
+                for (size_t row = 1; row + 1 < image.rows; ++row) {
+                    const size_t last_change = std::max({changed_at[row - 1], changed_at[row], changed_at[row + 1]});
+                    active[row] = last_change + 1 >= sub_iteration;
+                }
+
+                ForEachRow(pool, threads, 1, image.rows - 1, [&](const size_t row) {
+                    if (!active[row]) {
+                        return;
+                    }
+
+                    const uint64_t* up = source->Row(row - 1);
+                    const uint64_t* current = source->Row(row);
+                    const uint64_t* down = source->Row(row + 1);
+                    const bool changed = sub_iteration % 2 == 0
+                            ? ThinRow<0>(up, current, down, interior.data(), target->Row(row), words)
+                            : ThinRow<1>(up, current, down, interior.data(), target->Row(row), words);
+                    if (changed) {
+                        changed_at[row] = sub_iteration + 1;
+                    }
+                });
+
+                std::swap(source, target);
+
+                if (sub_iteration % 2 == 1) {
+                    const bool changed = std::any_of(changed_at.begin(), changed_at.end(), [&](const size_t at) {
+                        return at >= sub_iteration;
+                    });
+                    if (!changed) {
+                        break;
+                    }
+                }
+            }
+
+            if (source != &image) {
+                image.bits.swap(source->bits);
+            }
+        }
+
+        std::unique_ptr<thread_pool> MakePool(const size_t threads) {
+            return threads > 1 ? std::make_unique<thread_pool>(threads) : nullptr;
+        }
+    }
+
+    std::vector<uint64_t> GetSkeletonBits(const cv::Mat& colored_image, const size_t threads) {
+        const std::unique_ptr<thread_pool> pool = MakePool(threads);
+
+        BitImage image = Binarize(colored_image, pool.get(), threads);
+        Thin(image, pool.get(), threads);
+
+        return std::move(image.bits);
+    }
+
+    std::vector<uint64_t> GetTiledSkeletonBits(
+            const cv::Mat& colored_image,
+            const size_t tile_size,
+            const size_t halo,
+            const size_t threads
+    ) {
+        if (tile_size == 0) {
+            throw std::runtime_error{"Tile size should be positive"};
+        }
+
+        const std::unique_ptr<thread_pool> pool = MakePool(threads);
+
+        const int rows = colored_image.rows;
+        const int columns = colored_image.cols;
+        const int tile = static_cast<int>(tile_size);
+        const int margin = static_cast<int>(halo);
+        const size_t words_per_row = PreprocessedGraph::WordsPerRow(columns);
+        std::vector<uint64_t> bits(rows * words_per_row, 0);
+
+        for (int tile_row = 0; tile_row < rows; tile_row += tile) {
+            for (int tile_column = 0; tile_column < columns; tile_column += tile) {
+                const cv::Rect inner(tile_column, tile_row, std::min(tile, columns - tile_column), std::min(tile, rows - tile_row));
+
+                const int top = std::max(inner.y - margin, 0);
+                const int left = std::max(inner.x - margin, 0);
+                const cv::Rect outer(
+                        left,
+                        top,
+                        std::min(inner.x + inner.width + margin, columns) - left,
+                        std::min(inner.y + inner.height + margin, rows) - top);
+
+                BitImage skeleton = Binarize(colored_image(outer), pool.get(), threads);
+                Thin(skeleton, pool.get(), threads);
+
+                // Only inner part of tile is taken, halo is thinned by neighbour tiles
+                for (int row = inner.y; row < inner.y + inner.height; ++row) {
+                    const uint64_t* skeleton_row = skeleton.Row(row - top);
+                    uint64_t* bits_row = bits.data() + row * words_per_row;
+                    for (size_t word = 0; word < skeleton.words_per_row; ++word) {
+                        for (uint64_t word_bits = skeleton_row[word]; word_bits; word_bits &= word_bits - 1) {
+                            const int column = left + static_cast<int>(word * 64) + std::countr_zero(word_bits);
+                            if (column >= inner.x && column < inner.x + inner.width) {
+                                bits_row[column >> 6] |= uint64_t{1} << (column & 63);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        return bits;
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace ogr::thinning {
+    // Pixels brighter than threshold are background
+    constexpr uint8_t kThinningThreshold = 250;
+
+    /** Fixed point BGR to grayscale conversion (coefficients of cv::cvtColor) and inverse thresholding */
+    inline bool IsInk(const cv::Vec3b& pixel) {
+        return ((pixel[0] * 1868u + pixel[1] * 9617u + pixel[2] * 4899u + (1u << 13)) >> 14) <= kThinningThreshold;
+    }
+
+    /**
+     * Skeleton of colored image in PreprocessedGraph bits layout.
+     * Grayscale conversion, thresholding and Zhang-Suen thinning are fused over packed bits,
+     * skeleton is bit identical to cv::ximgproc::thinning of thresholded grayscale image.
+     * Thinning passes are split to row chunks between threads.
+     */
+    std::vector<uint64_t> GetSkeletonBits(const cv::Mat& colored_image, size_t threads = 1);
+
+    /**
+     * Same skeleton made tile by tile: every tile is thinned together with halo of neighbour pixels,
+     * so only tile sized buffers are allocated. Skeleton is same as for whole image while strokes are thinner than halo.
+     */
+    std::vector<uint64_t> GetTiledSkeletonBits(const cv::Mat& colored_image, size_t tile_size, size_t halo, size_t threads = 1);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ogr::utils {
+    /**
+     * Append only object pool. Objects are addressed by dense indices and never move,
+     * all of them are released at once with arena.
+     * Storage grows with blocks of doubling size: block b holds kFirstBlockSize * 2^b objects.
+     */
+    template <class T>
+    class Arena {
+    public:
+        using Index = uint32_t;
+        static constexpr Index kNullIndex = std::numeric_limits<Index>::max();
+
+    public:
+        Arena() = default;
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        template <typename... TArgs>
+        Index Make(TArgs&&... args) {
+            // Block is full by its intended size, reserve may give more capacity than asked
+            if (blocks_.empty() || blocks_.back().size() == BlockSize(blocks_.size() - 1)) {
+                blocks_.emplace_back();
+                blocks_.back().reserve(BlockSize(blocks_.size() - 1));
+            }
+
+            blocks_.back().emplace_back(std::forward<TArgs>(args)...);
+            return size_++;
+        }
+
+        T& operator[](const Index index) {
+            const auto [block, offset] = Locate(index);
+            return blocks_[block][offset];
+        }
+
+        const T& operator[](const Index index) const {
+            const auto [block, offset] = Locate(index);
+            return blocks_[block][offset];
+        }
+
+        [[nodiscard]] size_t Size() const {
+            return size_;
+        }
+
+    private:
+        static size_t BlockSize(const size_t block) {
+            return kFirstBlockSize << block;
+        }
+
+        static std::pair<size_t, size_t> Locate(const Index index) {
+            const size_t block = std::bit_width(index / kFirstBlockSize + 1) - 1;
+            const size_t offset = index - kFirstBlockSize * ((size_t{1} << block) - 1);
+            return {block, offset};
+        }
+
+    private:
+        static constexpr size_t kFirstBlockSize = 64;
+
+        std::vector<std::vector<T>> blocks_;
+        Index size_{0};
+    };
+}
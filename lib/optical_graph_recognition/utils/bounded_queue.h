@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace ogr::utils {
+    /**
+     * Blocking FIFO queue of limited capacity between pipeline stages.
+     * Producer waits while queue is full (back-pressure), consumer waits while queue is empty.
+     * Closed queue refuses new items, consumers drain rest of items.
+     */
+    template <class T>
+    class BoundedQueue {
+    public:
+        using Duration = std::chrono::duration<double, std::milli>;
+
+        struct Stats {
+            size_t capacity;
+            size_t max_size;
+            // Pushes blocked by full queue and time producers spent in them
+            size_t blocked_pushes;
+            Duration push_wait;
+            // Time consumers spent waiting for items
+            Duration pop_wait;
+        };
+
+    public:
+        explicit BoundedQueue(const size_t capacity)
+            : capacity_(std::max<size_t>(capacity, 1)) {
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        /** Returns false if queue is closed, item is dropped */
+        bool Push(T item) {
+            std::unique_lock lock(mutex_);
+            if (items_.size() >= capacity_ && !closed_) {
+                const auto start = Clock::now();
+                not_full_.wait(lock, [this] { return items_.size() < capacity_ || closed_; });
+                push_wait_ += Clock::now() - start;
+                ++blocked_pushes_;
+            }
+
+            if (closed_) {
+                return false;
+            }
+
+            items_.push_back(std::move(item));
+            max_size_ = std::max(max_size_, items_.size());
+            not_empty_.notify_one();
+            return true;
+        }
+
+        /** Returns nullopt if queue is closed and drained */
+        std::optional<T> Pop() {
+            std::unique_lock lock(mutex_);
+            if (items_.empty() && !closed_) {
+                const auto start = Clock::now();
+                not_empty_.wait(lock, [this] { return !items_.empty() || closed_; });
+                pop_wait_ += Clock::now() - start;
+            }
+
+            if (items_.empty()) {
+                return std::nullopt;
+            }
+
+            T item = std::move(items_.front());
+            items_.pop_front();
+            not_full_.notify_one();
+            return item;
+        }
+
+        void Close() {
+            std::lock_guard lock(mutex_);
+            closed_ = true;
+            not_full_.notify_all();
+            not_empty_.notify_all();
+        }
+
+        Stats GetStats() const {
+            std::lock_guard lock(mutex_);
+            return Stats{
+                .capacity = capacity_,
+                .max_size = max_size_,
+                .blocked_pushes = blocked_pushes_,
+                .push_wait = push_wait_,
+                .pop_wait = pop_wait_
+            };
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        const size_t capacity_;
+        std::deque<T> items_;
+        bool closed_{false};
+
+        mutable std::mutex mutex_;
+        std::condition_variable not_full_;
+        std::condition_variable not_empty_;
+
+        size_t max_size_{0};
+        size_t blocked_pushes_{0};
+        Duration push_wait_{0};
+        Duration pop_wait_{0};
+    };
+}
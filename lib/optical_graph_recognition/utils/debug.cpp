@@ -37,7 +37,7 @@ namespace ogr::debug {
         const std::filesystem::path output = dev_dir / (std::to_string(seq_id) + ".png");
 
         cv::Mat image = vertex_filter.has_value()
-                ? opencv::Grm2CvMat(grm, utils::EdgePointFilterWithSourceVertex{*vertex_filter})
+                ? opencv::Grm2CvMat(grm, utils::EdgePointFilterWithSourceVertex(*vertex_filter))
                 : opencv::Grm2CvMat(grm);
 
         tp.push_task([=]() {
@@ -57,14 +57,14 @@ namespace ogr::debug {
         ss << "Vertex info: ";
         ss << "Id = " << vertex.id << "; ";
         ss << "Points: [";
-        for (const point::WeakPointPtr point : vertex.points) {
-            ss << DebugDump(*point.lock()) << " ";
+        for (const point::Point& point : vertex.points) {
+            ss << DebugDump(point) << " ";
         }
         ss << "]; ";
 
         ss << "Port points: [";
-        for (const point::WeakPointPtr point : vertex.port_points) {
-            ss << DebugDump(*point.lock()) << " ";
+        for (const point::Point& point : vertex.port_points) {
+            ss << DebugDump(point) << " ";
         }
         ss << "];";
 
@@ -77,14 +77,14 @@ namespace ogr::debug {
         ss << "Size = " << step.Size() << "; ";
 
         if (step.Size() >= 2) {
-            ss << "Angle = " << step.GetDirectionAngle() << "; ";
+            ss << "Angle = " << step.GetDirectionAngle().ToDegrees() << "; ";
         }
 
-        ss << "Start point = " << DebugDump(*step.Front()) << "; ";
-        ss << "End point = " << DebugDump(*step.Back()) << "; ";
+        ss << "Start point = " << DebugDump(step.Front()) << "; ";
+        ss << "End point = " << DebugDump(step.Back()) << "; ";
         ss << "Points = ";
-        for (auto point : step.GetPoints()) {
-            ss << DebugDump(*point) << " ";
+        for (const point::Point& point : step.GetPoints()) {
+            ss << DebugDump(point) << " ";
         }
 
         return ss.str();
@@ -93,19 +93,19 @@ namespace ogr::debug {
     std::string DebugDump(const crawler::IStepTreeNode& step_tree_node) {
         std::stringstream ss;
         ss << "Step tree node info: ";
-        ss << "Point = " << DebugDump(*(step_tree_node.GetStep()->Back())) << "; ";
+        ss << "Point = " << DebugDump(step_tree_node.GetStep()->Back()) << "; ";
 
         ss << "IsStable = " << step_tree_node.IsStable() << "; ";
         ss << "IsValid = " << step_tree_node.IsValid() << "; ";
-        ss << "StateAngle = " << static_cast<int>(step_tree_node.GetStateAngle()) << "; ";
+        ss << "StateAngle = " << static_cast<int>(step_tree_node.GetStateAngle().ToDegrees()) << "; ";
         if (step_tree_node.GetStep()->Size() >= 2) {
-            ss << "StepAngle = " << static_cast<int>(step_tree_node.GetLastStepAngle()) << "; ";
+            ss << "StepAngle = " << static_cast<int>(step_tree_node.GetLastStepAngle().ToDegrees()) << "; ";
         }
 
-        ss << "DiffStates = " << static_cast<int>(step_tree_node.GetDiffAngleWithPrevState()) << "; ";
-        ss << "DiffStables = " << static_cast<int>(step_tree_node.GetDiffAngleWithPrevStableState()) << "; ";
+        ss << "DiffStates = " << static_cast<int>(step_tree_node.GetDiffAngleWithPrevState().ToDegrees()) << "; ";
+        ss << "DiffStables = " << static_cast<int>(step_tree_node.GetDiffAngleWithPrevStableState().ToDegrees()) << "; ";
         if (step_tree_node.GetStep()->Size() >= 2) {
-            ss << "DiffStep = " << static_cast<int>(step_tree_node.GetDiffAngleWithLastStep()) << "; ";
+            ss << "DiffStep = " << static_cast<int>(step_tree_node.GetDiffAngleWithLastStep().ToDegrees()) << "; ";
         }
 
         ss << "Depth = " << step_tree_node.GetDepth() << "; ";
@@ -113,13 +113,4 @@ namespace ogr::debug {
 
         return ss.str();
     }
-
-    std::string DebugDump(const crawler::IEdgeCrawler& crawler) {
-        std::stringstream ss;
-        ss << "Crawler info: ";
-        ss << "Current step tree node info: ";
-        ss << DebugDump(*crawler.GetCurrentStepTreeNode());
-
-        return ss.str();
-    }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ogr_components/matrix.h>
+#include <ogr_components/structured_elements.h>
 
 #include <opencv2/opencv.hpp>
 
@@ -13,7 +14,6 @@
 namespace ogr::crawler {
     struct IStep;
     struct IStepTreeNode;
-    struct IEdgeCrawler;
 }
 
 namespace ogr::debug {
@@ -25,7 +25,6 @@ namespace ogr::debug {
     std::string DebugDump(const Vertex&);
     std::string DebugDump(const crawler::IStep&);
     std::string DebugDump(const crawler::IStepTreeNode&);
-    std::string DebugDump(const crawler::IEdgeCrawler&);
 
     template <typename... TupleArgs>
     inline std::string DebugDump(const std::tuple<TupleArgs...>& data) {
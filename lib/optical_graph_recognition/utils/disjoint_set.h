@@ -1,51 +1,52 @@
 #pragma once
 
-namespace ogr::utils {
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
 
-    class DisjointSet {
-    public:
-        using SetId = size_t;
+namespace ogr::utils {
+    /**
+     * Flat union-find over dense ids [0, size).
+     * Find halves paths iteratively and union attaches smaller tree to larger one,
+     * so trees stay shallow even for huge components.
+     */
+    class DisjointSets {
     public:
-        explicit DisjointSet(SetId id) : id_(id), parent_(this) {}
-
-        template <typename Iterable>
-        friend void MergeSets(Iterable sets);
+        explicit DisjointSets(const size_t size)
+            : parent_(size)
+            , size_(size, 1) {
+            std::iota(parent_.begin(), parent_.end(), 0);
+        }
 
-        SetId GetId() {
-            if (parent_ == this) {
-                return id_;
+        uint32_t Find(uint32_t id) {
+            while (parent_[id] != id) {
+                parent_[id] = parent_[parent_[id]];
+                id = parent_[id];
             }
-            return parent_->GetId();
+
+            return id;
         }
 
-        DisjointSet* GetSetSource() {
-            if (parent_ == this) {
-                return this;
+        /** Returns root of merged set */
+        uint32_t Union(uint32_t id1, uint32_t id2) {
+            id1 = Find(id1);
+            id2 = Find(id2);
+            if (id1 == id2) {
+                return id1;
             }
 
-            parent_ = parent_->GetSetSource();
-            return parent_;
-        }
+            if (size_[id1] < size_[id2]) {
+                std::swap(id1, id2);
+            }
+            parent_[id2] = id1;
+            size_[id1] += size_[id2];
 
-        void Merge(DisjointSet* set) {
-            DisjointSet* set_source = GetSetSource();
-            set_source->parent_ = set->GetSetSource();
+            return id1;
         }
+
     private:
-        const SetId id_;
-        DisjointSet* parent_{nullptr};
+        std::vector<uint32_t> parent_;
+        std::vector<uint32_t> size_;
     };
-
-    template <typename Iterable>
-    inline void MergeDisjointSets(Iterable sets) {
-        DisjointSet* common_parent = nullptr;
-        for (DisjointSet* set : sets) {
-            if (common_parent == nullptr) {
-                common_parent = set;
-                continue;
-            }
-            set->Merge(common_parent);
-            assert(set->GetId() == common_parent->GetId());
-        }
-    }
-}
\ No newline at end of file
+}
@@ -1,92 +1,89 @@
 #pragma once
 
-#include <exception>
+#include <array>
+#include <cmath>
+#include <compare>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
 
 namespace ogr::utils {
-    struct PlanarVector {
-        double x = 0;
-        double y = 0;
-
-        void Normalize() {
-            constexpr double kEps = 1e-6;
-            const double module = Abs();
-            if (module <= kEps) {
-                throw std::runtime_error{"Invalid normalize operation over 0 vector"};
-            }
-
-            x /= module;
-            y /= module;
+    /**
+     * Binary angle: full turn is 2^16 units, so angles wrap around by plain integer overflow
+     * and difference of angles is 16 bit subtraction without any normalization.
+     */
+    struct BinaryAngle {
+        static constexpr double kUnitsPerDegree = 65536.0 / 360.0;
+
+        uint16_t value = 0;
+
+        static constexpr BinaryAngle FromDegrees(const double degrees) {
+            const double units = degrees * kUnitsPerDegree;
+            const int64_t rounded = static_cast<int64_t>(units >= 0 ? units + 0.5 : units - 0.5);
+            return BinaryAngle{.value = static_cast<uint16_t>(rounded)};
         }
 
-        double GetAngle() {
-            const double angle = atan(fabs(y) / fabs(x));
-            assert(angle >= 0);
-
-            if (y >= 0 && x >= 0) {
-                return angle;
-            }
-
-            if (y >= 0 && x <= 0) {
-                return M_PI - angle;
-            }
-
-            if (y <= 0 && x <= 0) {
-                return M_PI + angle;
-            }
-
-            return 2 * M_PI - angle;
+        constexpr double ToDegrees() const {
+            return value / kUnitsPerDegree;
         }
 
-        double Abs() noexcept {
-            return sqrt(x * x + y * y);
-        }
+        constexpr auto operator<=>(const BinaryAngle&) const = default;
     };
 
-    inline double Rad2Deg(double rad) {
-        return rad * 180.0 / M_PI;
+    /** Difference angle1 - angle2 in range [-half turn, half turn) */
+    inline int32_t SignedDiffAngles(const BinaryAngle angle1, const BinaryAngle angle2) {
+        return static_cast<int16_t>(angle1.value - angle2.value);
     }
 
-    inline double NormalizeAngle(const double angle) {
-        assert(angle >= -360 && angle <= 720);
-
-        if (angle < 0) {
-            return 360 + angle;
-        }
-
-        if (angle >= 360) {
-            return angle - 360;
-        }
-
-        return angle;
+    /** Unsigned difference of angles in range [0, half turn] */
+    inline BinaryAngle AbsDiffAngles(const BinaryAngle angle1, const BinaryAngle angle2) {
+        return BinaryAngle{.value = static_cast<uint16_t>(std::abs(SignedDiffAngles(angle1, angle2)))};
     }
 
-    inline double AbsDiffAngles(double angle1, double angle2) {
-        angle1 = NormalizeAngle(angle1);
-        angle2 = NormalizeAngle(angle2);
-        const double max = std::max(angle1, angle2);
-        const double min = std::min(angle1, angle2);
-        assert(max >= 0 && max < 360);
-        assert(min >= 0 && min < 360);
-
-        const double result = max - min <= min + 360 - max ? max - min : min + 360 - max;
-        assert(result >= 0 && result < 180);
+    inline BinaryAngle RotateAngle(const BinaryAngle angle, const int32_t delta) {
+        return BinaryAngle{.value = static_cast<uint16_t>(angle.value + delta)};
+    }
 
-        return result;
+    /** Direction angle of integer vector (x, y) computed with trigonometry */
+    inline BinaryAngle ComputeDirectionAngle(const int x, const int y) {
+        return BinaryAngle::FromDegrees(std::atan2(y, x) * 180.0 / M_PI);
     }
 
-    inline double AlignAngle(const double angle, const double sample) {
-        assert(angle >= 0 && angle < 360);
-        assert(sample >= 0 && sample <= 360);
+    /**
+     * Direction angle of integer vector (x, y) with |x|, |y| <= Radius.
+     * Angles of all vectors in box are computed once, so there is no trigonometry on lookup.
+     */
+    template <int Radius>
+    BinaryAngle DirectionAngle(const int x, const int y) {
+        constexpr int kSide = 2 * Radius + 1;
+        static const std::array<BinaryAngle, kSide * kSide> kDirections = [] {
+            std::array<BinaryAngle, kSide * kSide> directions{};
+            for (int dy = -Radius; dy <= Radius; ++dy) {
+                for (int dx = -Radius; dx <= Radius; ++dx) {
+                    directions[(dy + Radius) * kSide + dx + Radius] = ComputeDirectionAngle(dx, dy);
+                }
+            }
+            return directions;
+        }();
 
-        if (fabs(sample - angle) <= 180) {
-            return angle;
+        if (std::abs(x) > Radius || std::abs(y) > Radius) {
+            throw std::runtime_error{"Vector is out of directions table"};
         }
 
-        if (sample < 180) {
-            return angle - 360;
-        }
+        return kDirections[(y + Radius) * kSide + x + Radius];
+    }
 
-        assert(angle < 180);
-        return 360 + angle;
+    /** Z-order (Morton) code of 2d point: bits of row and column are interleaved */
+    inline uint64_t MortonCode(const uint32_t row, const uint32_t column) {
+        auto spread = [](uint64_t x) {
+            x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+            x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+            x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+            x = (x | (x << 2)) & 0x3333333333333333ull;
+            x = (x | (x << 1)) & 0x5555555555555555ull;
+            return x;
+        };
+
+        return (spread(row) << 1) | spread(column);
     }
 }
\ No newline at end of file
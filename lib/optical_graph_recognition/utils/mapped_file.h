@@ -0,0 +1,53 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <filesystem>
+
+namespace ogr::utils {
+    /** Read-only memory mapping of whole file, mapping is empty if file can't be mapped */
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::filesystem::path& path) {
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return;
+            }
+
+            struct stat st{};
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                void* data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data != MAP_FAILED) {
+                    data_ = static_cast<const uint8_t*>(data);
+                    size_ = static_cast<size_t>(st.st_size);
+                }
+            }
+            ::close(fd);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile() {
+            if (data_) {
+                ::munmap(const_cast<uint8_t*>(data_), size_);
+            }
+        }
+
+        const uint8_t* Data() const {
+            return data_;
+        }
+
+        size_t Size() const {
+            return size_;
+        }
+
+    private:
+        const uint8_t* data_{nullptr};
+        size_t size_{0};
+    };
+}
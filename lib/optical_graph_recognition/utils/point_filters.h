@@ -1,79 +1,72 @@
 #pragma once
 
-#include <ogr_components/point.h>
+#include <ogr_components/matrix.h>
 
 namespace ogr::utils {
-    struct IPointFilter {
-        virtual point::PointPtr operator()(point::PointPtr point) const = 0;
-        virtual ~IPointFilter() = default;
-    };
-
-    struct IdentityPointFilter : IPointFilter {
-        point::PointPtr operator()(point::PointPtr point) const override {
-            return point;
-        }
-    };
-
-    struct EdgePointFilterWithSourceVertex : IPointFilter {
-        VertexId source;
-
-        explicit EdgePointFilterWithSourceVertex(VertexId vid) : source(vid) {}
-
-        point::PointPtr operator()(point::PointPtr point) const override {
-            if (!point::IsEdgePoint(point)) {
-                return point;
+    /**
+     * Point filter returns state of point as it should be considered by consumer.
+     * Filter kind is stored as a tag and dispatched with switch, so filtering is not virtual.
+     */
+    class PointFilter {
+    public:
+        enum class Kind : uint8_t {
+            Identity,
+            EdgeWithSourceVertex,
+            EdgeWithVertex,
+            Edge
+        };
+
+    public:
+        PointFilter() = default;
+
+        PointFilter(const Kind kind, const size_t id) : kind_(kind), id_(id) {}
+
+        point::PointState operator()(const matrix::Grm& grm, const point::Point& point) const {
+            if (kind_ == Kind::Identity || !point::IsEdgePoint(point)) {
+                return *point.state;
             }
 
-            point::EdgePointPtr edge_point = std::dynamic_pointer_cast<point::EdgePoint>(point);
-            for (const std::weak_ptr<Edge> edge : edge_point->edges) {
-                if (edge.lock()->v1 == source) {
-                    return point;
+            for (const EdgeId edge_id : grm.GetEdges(point)) {
+                if (Match(edge_id, grm.GetEdgeEndpoints(edge_id))) {
+                    return *point.state;
                 }
             }
 
-            return std::make_shared<point::FilledPoint>(point->row, point->column);
+            return point::PointState{.kind = point::PointKind::Filled};
         }
-    };
-
-    struct EdgePointFilterWithVertex : IPointFilter {
-        VertexId vertex_id;
 
-        explicit EdgePointFilterWithVertex(VertexId vid) : vertex_id(vid) {}
-
-        point::PointPtr operator()(point::PointPtr point) const override {
-            if (!point::IsEdgePoint(point)) {
-                return point;
+    private:
+        bool Match(const EdgeId edge_id, const matrix::Grm::EdgeEndpoints& edge) const {
+            switch (kind_) {
+                case Kind::EdgeWithSourceVertex:
+                    return edge.v1 == id_;
+                case Kind::EdgeWithVertex:
+                    return edge.v1 == id_ || edge.v2 == id_;
+                case Kind::Edge:
+                    return edge_id == id_;
+                default:
+                    return true;
             }
-
-            point::EdgePointPtr edge_point = std::dynamic_pointer_cast<point::EdgePoint>(point);
-            for (const std::weak_ptr<Edge> edge : edge_point->edges) {
-                if (edge.lock()->v1 == vertex_id || edge.lock()->v2 == vertex_id) {
-                    return point;
-                }
-            }
-
-            return std::make_shared<point::FilledPoint>(point->row, point->column);
         }
-    };
 
-    struct EdgePointFilter : IPointFilter {
-        EdgeId edge_id;
+    private:
+        Kind kind_{Kind::Identity};
+        size_t id_{0};
+    };
 
-        explicit EdgePointFilter(EdgeId eid) : edge_id(eid) {}
+    inline PointFilter IdentityPointFilter() {
+        return PointFilter{};
+    }
 
-        point::PointPtr operator()(point::PointPtr point) const override {
-            if (!point::IsEdgePoint(point)) {
-                return point;
-            }
+    inline PointFilter EdgePointFilterWithSourceVertex(const VertexId vid) {
+        return PointFilter{PointFilter::Kind::EdgeWithSourceVertex, vid};
+    }
 
-            point::EdgePointPtr edge_point = std::dynamic_pointer_cast<point::EdgePoint>(point);
-            for (const std::weak_ptr<Edge> edge : edge_point->edges) {
-                if (edge.lock()->id == edge_id) {
-                    return point;
-                }
-            }
+    inline PointFilter EdgePointFilterWithVertex(const VertexId vid) {
+        return PointFilter{PointFilter::Kind::EdgeWithVertex, vid};
+    }
 
-            return std::make_shared<point::FilledPoint>(point->row, point->column);
-        }
-    };
+    inline PointFilter EdgePointFilter(const EdgeId eid) {
+        return PointFilter{PointFilter::Kind::Edge, eid};
+    }
 }
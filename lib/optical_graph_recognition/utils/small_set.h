@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace ogr::utils {
+    /**
+     * Sorted set of small trivial values with inline storage.
+     * Up to InlineSize items are kept in place, bigger sets spill to heap vector.
+     */
+    template <class TItem, size_t InlineSize>
+    class SmallSet {
+    public:
+        using value_type = TItem;
+        using const_iterator = const TItem*;
+
+    public:
+        /** Returns false if item is already in set */
+        bool Insert(const TItem& item) {
+            if (IsSpilled()) {
+                auto it = std::lower_bound(heap_.begin(), heap_.end(), item);
+                if (it != heap_.end() && *it == item) {
+                    return false;
+                }
+                heap_.insert(it, item);
+                return true;
+            }
+
+            TItem* const end = inline_.data() + size_;
+            TItem* it = std::lower_bound(inline_.data(), end, item);
+            if (it != end && *it == item) {
+                return false;
+            }
+
+            if (size_ == InlineSize) {
+                heap_.reserve(InlineSize * 2);
+                heap_.insert(heap_.end(), inline_.data(), it);
+                heap_.push_back(item);
+                heap_.insert(heap_.end(), it, end);
+                size_ = 0;
+                return true;
+            }
+
+            std::move_backward(it, end, end + 1);
+            *it = item;
+            ++size_;
+            return true;
+        }
+
+        /** Returns false if item is not in set */
+        bool Erase(const TItem& item) {
+            if (IsSpilled()) {
+                auto it = std::lower_bound(heap_.begin(), heap_.end(), item);
+                if (it == heap_.end() || *it != item) {
+                    return false;
+                }
+                heap_.erase(it);
+                return true;
+            }
+
+            TItem* const end = inline_.data() + size_;
+            TItem* it = std::lower_bound(inline_.data(), end, item);
+            if (it == end || *it != item) {
+                return false;
+            }
+
+            std::move(it + 1, end, it);
+            --size_;
+            return true;
+        }
+
+        bool Contains(const TItem& item) const {
+            return std::binary_search(begin(), end(), item);
+        }
+
+        [[nodiscard]] size_t Size() const {
+            return IsSpilled() ? heap_.size() : size_;
+        }
+
+        [[nodiscard]] bool Empty() const {
+            return !Size();
+        }
+
+        const_iterator begin() const {
+            return IsSpilled() ? heap_.data() : inline_.data();
+        }
+
+        const_iterator end() const {
+            return begin() + Size();
+        }
+
+    private:
+        bool IsSpilled() const {
+            return !heap_.empty();
+        }
+
+    private:
+        std::array<TItem, InlineSize> inline_;
+        uint32_t size_{0};
+        std::vector<TItem> heap_;
+    };
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ogr::utils {
+    /**
+     * Fixed size zero initialized array of trivial items.
+     * Array is kept in heap or, if spill dir is set, in shared mapping of unlinked temporary file there:
+     * pages of such array are written back and evicted by kernel under memory pressure and paged in on access.
+     */
+    template <typename T>
+    class SpillArray {
+        static_assert(std::is_trivially_copyable_v<T>, "Spilled items are copied as bytes");
+
+    public:
+        SpillArray() = default;
+
+        explicit SpillArray(const size_t size, std::optional<std::filesystem::path> spill_dir = std::nullopt)
+            : spill_dir_(std::move(spill_dir)) {
+            if (!spill_dir_.has_value() || size == 0) {
+                heap_.resize(size);
+                data_ = heap_.data();
+                size_ = size;
+                return;
+            }
+
+            std::string path_template = (*spill_dir_ / "ogr-spill-XXXXXX").string();
+            const int fd = ::mkstemp(path_template.data());
+            if (fd < 0) {
+                throw std::runtime_error{"Can't create spill file in " + spill_dir_->string()};
+            }
+            // File is removed right away, its space is released on unmap
+            ::unlink(path_template.c_str());
+
+            void* data = MAP_FAILED;
+            if (::ftruncate(fd, static_cast<off_t>(size * sizeof(T))) == 0) {
+                data = ::mmap(nullptr, size * sizeof(T), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            ::close(fd);
+
+            if (data == MAP_FAILED) {
+                throw std::runtime_error{"Can't map spill file in " + spill_dir_->string()};
+            }
+
+            data_ = static_cast<T*>(data);
+            size_ = size;
+            mapped_ = true;
+        }
+
+        SpillArray(const SpillArray& other)
+            : SpillArray(other.size_, other.spill_dir_) {
+            std::copy(other.begin(), other.end(), begin());
+        }
+
+        SpillArray(SpillArray&& other) noexcept {
+            Swap(other);
+        }
+
+        SpillArray& operator=(SpillArray other) noexcept {
+            Swap(other);
+            return *this;
+        }
+
+        ~SpillArray() {
+            if (mapped_) {
+                ::munmap(data_, size_ * sizeof(T));
+            }
+        }
+
+        bool IsSpilled() const {
+            return mapped_;
+        }
+
+        T* data() {
+            return data_;
+        }
+
+        const T* data() const {
+            return data_;
+        }
+
+        size_t size() const {
+            return size_;
+        }
+
+        T& operator[](const size_t index) {
+            return data_[index];
+        }
+
+        const T& operator[](const size_t index) const {
+            return data_[index];
+        }
+
+        T* begin() {
+            return data_;
+        }
+
+        T* end() {
+            return data_ + size_;
+        }
+
+        const T* begin() const {
+            return data_;
+        }
+
+        const T* end() const {
+            return data_ + size_;
+        }
+
+    private:
+        void Swap(SpillArray& other) noexcept {
+            std::swap(spill_dir_, other.spill_dir_);
+            std::swap(heap_, other.heap_);
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+            std::swap(mapped_, other.mapped_);
+        }
+
+    private:
+        std::optional<std::filesystem::path> spill_dir_;
+        std::vector<T> heap_;
+        T* data_{nullptr};
+        size_t size_{0};
+        bool mapped_{false};
+    };
+}
@@ -1,32 +1,47 @@
 #pragma once
 
-#include <ogr_components/point.h>
-#include <utils/opencv_utils.h>
+#include <opencv2/opencv.hpp>
+
+#include <bit>
+#include <cstdint>
 
 namespace ogr::vertex {
+    /**
+     * Vertex pixels are pixels close to sample color.
+     * Detector is bulk policy of image ingestion, colors are compared by squared distance.
+     */
     class VertexPointsDetectorByColor {
-        static constexpr double kDefaultThreshold = 80.0;
     public:
-        VertexPointsDetectorByColor(const cv::Mat &source_colored_image, const cv::Vec3b &color,
-                                    const double threshold = kDefaultThreshold)
-                : source_image_(source_colored_image), sample_color_(color), threshold_(threshold) {}
-
-        bool operator()(const point::PointPtr &point) const {
-            const int row = static_cast<int>(point->row);
-            const int column = static_cast<int>(point->column);
-
-            const cv::Point cv_point(column, row);
-            const cv::Vec3b point_color = source_image_.at<cv::Vec3b>(cv_point);
-            if (opencv::ColorDistance(sample_color_, point_color) < threshold_) {
-                return true;
+        static constexpr double kDefaultThreshold = 80.0;
+
+        explicit VertexPointsDetectorByColor(const cv::Vec3b &color, const double threshold = kDefaultThreshold)
+                : sample_color_(color), squared_threshold_(threshold * threshold) {}
+
+        bool operator()(const cv::Vec3b &pixel) const {
+            int squared_distance = 0;
+            for (int i = 0; i < 3; ++i) {
+                const int diff = static_cast<int>(pixel[i]) - sample_color_[i];
+                squared_distance += diff * diff;
+            }
+
+            return squared_distance < squared_threshold_;
+        }
+
+        /** Candidates are bits of 64 pixels starting from given one, result is candidates with vertex color */
+        uint64_t operator()(const cv::Vec3b *pixels, uint64_t candidates) const {
+            uint64_t result = 0;
+            for (; candidates; candidates &= candidates - 1) {
+                const int bit = std::countr_zero(candidates);
+                if ((*this)(pixels[bit])) {
+                    result |= uint64_t{1} << bit;
+                }
             }
 
-            return false;
+            return result;
         }
 
     private:
-        const cv::Mat &source_image_;
         cv::Vec3b sample_color_;
-        const double threshold_{kDefaultThreshold};
+        double squared_threshold_;
     };
-}
\ No newline at end of file
+}
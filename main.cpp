@@ -1,6 +1,8 @@
 #include <optical_graph_recognition/algo_params/params.h>
+#include <optical_graph_recognition/cache/skeleton_cache.h>
 #include <optical_graph_recognition/optical_graph_recognition.h>
 #include <optical_graph_recognition/reporter.h>
+#include <optical_graph_recognition/thinning/thinning.h>
 #include <optical_graph_recognition/utils/opencv_utils.h>
 #include <optical_graph_recognition/vertex/detectors.h>
 #include <optical_graph_recognition/utils/debug.h>
@@ -14,8 +16,21 @@
 #include <CLI/Config.hpp>
 #include <CLI/Formatter.hpp>
 
+#include <optical_graph_recognition/utils/bounded_queue.h>
+
+#include <thread_pool.hpp>
+
+#include <chrono>
+#include <cmath>
 #include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <set>
+#include <sstream>
 
 
 using Fpath = std::filesystem::path;
@@ -29,7 +44,7 @@ struct OgrParams {
 };
 
 struct InputCliParams {
-    Fpath input_dir;
+    std::vector<Fpath> input_dirs;
     std::string baseline_name;
     Fpath output_dir;
     std::string log_level;
@@ -37,45 +52,262 @@ struct InputCliParams {
     std::optional<std::string> filter;
     bool only_report;
     bool dump_edges;
+    std::string grid_layout;
+    size_t memory_budget_mb;
+    Fpath spill_dir;
+    size_t tile_size;
+    size_t tile_halo;
+    bool locality_order;
+    size_t threads;
+    size_t jobs;
+    size_t queue_capacity;
+    bool pipeline_stats;
+    std::optional<Fpath> cache_dir;
+    size_t cache_size_mb;
+    std::shared_ptr<ogr::cache::SkeletonCache> skeleton_cache;
+    bool save_snapshots;
+    std::string reuse_snapshots;
+    size_t beam_width;
+    ogr::crawler::CrawlerSizes crawler_sizes;
+    bool benchmark;
+
+    std::optional<std::string> sweep_curvature;
+    std::optional<std::string> sweep_stable_diff;
+    std::optional<std::string> sweep_state_diff;
 
     OgrParams ogr_baseline_params;
     OgrParams ogr_algo_params;
 };
 
-ogr::OpticalGraphRecognition ProcessImage(const std::filesystem::path& input_img, const OgrParams& ogr_params, const InputCliParams& input_params) {
-    // Step 1: Read image
+// Sidecar file with per image params: <image stem>.meta
+const std::string kMetaExtension = ".meta";
+
+// Snapshots of recognized images are stored in output dir: <image stem>.snap
+const std::string kSnapshotExtension = ".snap";
+
+/**
+ * Crawler sizes for image: CLI ones are overridden by "step-size = N" and "sub-path-steps = N" lines of image meta file
+ */
+ogr::crawler::CrawlerSizes GetImageCrawlerSizes(const Fpath& input_img, const InputCliParams& input_params) {
+    ogr::crawler::CrawlerSizes crawler_sizes = input_params.crawler_sizes;
+
+    Fpath meta_path = input_img;
+    meta_path.replace_extension(kMetaExtension);
+    if (!FS::exists(meta_path)) {
+        return crawler_sizes;
+    }
+
+    std::ifstream meta{meta_path};
+    std::string line;
+    while (std::getline(meta, line)) {
+        std::istringstream ss{line};
+        std::string key;
+        if (!(ss >> key) || key.front() == '#') {
+            continue;
+        }
+
+        std::string separator;
+        size_t value;
+        if (!(ss >> separator >> value) || separator != "=") {
+            throw std::runtime_error{"Invalid line in " + meta_path.string() + ": " + line};
+        }
+
+        if (key == "step-size") {
+            crawler_sizes.step_size = value;
+        } else if (key == "sub-path-steps") {
+            crawler_sizes.sub_path_steps_size = value;
+        } else {
+            throw std::runtime_error{"Unknown param in " + meta_path.string() + ": " + key};
+        }
+    }
+
+    return crawler_sizes;
+}
+
+/**
+ * Values of swept param: comma separated list of values and inclusive ranges start:stop:step (e.g. "10,15:30:5"),
+ * default value is used if param is not swept
+ */
+std::vector<double> ParseSweepValues(const std::optional<std::string>& spec, const double default_value) {
+    if (!spec.has_value()) {
+        return {default_value};
+    }
+
+    std::vector<double> values;
+    std::istringstream items{*spec};
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        std::vector<double> bounds;
+        std::istringstream parts{item};
+        std::string part;
+        while (std::getline(parts, part, ':')) {
+            bounds.push_back(std::stod(part));
+            if (!std::isfinite(bounds.back()) || bounds.back() < 0) {
+                throw std::runtime_error{"Invalid sweep value: " + part + ", expected non negative number of degrees"};
+            }
+        }
+
+        if (bounds.size() == 1) {
+            values.push_back(bounds[0]);
+            continue;
+        }
+
+        if (bounds.size() != 3 || bounds[2] <= 0) {
+            throw std::runtime_error{"Invalid sweep range: " + item + ", expected start:stop:step with positive step"};
+        }
+
+        // Values are computed from index to avoid accumulation of step error
+        constexpr double kEps = 1e-9;
+        for (size_t i = 0; bounds[0] + i * bounds[2] <= bounds[1] + kEps; ++i) {
+            values.push_back(bounds[0] + i * bounds[2]);
+        }
+    }
+
+    if (values.empty()) {
+        throw std::runtime_error{"Empty sweep values: " + *spec};
+    }
+
+    return values;
+}
+
+// Vertexes are marked with black color in source images
+const cv::Vec3b kVertexColor{0, 0, 0};
+
+/** Everything that affects thinned skeleton and detected vertexes, it's part of skeleton cache key */
+std::string GetPreprocessingParams(const InputCliParams& input_params) {
+    std::stringstream ss;
+    ss << "thinning-threshold=" << +ogr::thinning::kThinningThreshold
+       << ";vertex-color=" << +kVertexColor[0] << "," << +kVertexColor[1] << "," << +kVertexColor[2]
+       << ";vertex-threshold=" << ogr::vertex::VertexPointsDetectorByColor::kDefaultThreshold;
+    if (input_params.tile_size) {
+        ss << ";tile-size=" << input_params.tile_size << ";tile-halo=" << input_params.tile_halo;
+    }
+    return ss.str();
+}
+
+ogr::matrix::GridOptions GetGridOptions(const InputCliParams& input_params) {
+    ogr::matrix::GridOptions options{
+        .memory_budget = input_params.memory_budget_mb << 20,
+        .spill_dir = input_params.spill_dir
+    };
+
+    if (input_params.grid_layout == "row-major") {
+        options.layout = ogr::matrix::Layout::RowMajor;
+    } else if (input_params.grid_layout == "tiled") {
+        options.layout = ogr::matrix::Layout::Tiled;
+    } else if (input_params.grid_layout == "sparse") {
+        options.layout = ogr::matrix::Layout::Sparse;
+    } else {
+        throw std::runtime_error{"Invalid grid-layout param, only 'row-major', 'tiled' or 'sparse' allowed"};
+    }
+
+    return options;
+}
+
+struct DecodedImage {
+    Fpath path;
+    cv::Mat colored;
+
+    // Mapped preprocessing result from skeleton cache, image isn't decoded on cache hit
+    std::string cache_key;
+    std::optional<ogr::cache::CacheEntry> cached;
+};
+
+/** Step 1: image is decoded once, thinning and vertexes detection work on colored buffer */
+DecodedImage DecodeImage(const Fpath& input_img, const InputCliParams& input_params) {
     LOG_INFO << "Read input image: " << input_img;
 
-    cv::Mat colored_image = cv::imread(input_img, cv::ImreadModes::IMREAD_COLOR);
-    cv::Mat grayscale_image = cv::imread(input_img, cv::ImreadModes::IMREAD_GRAYSCALE);
+    std::ifstream input(input_img, std::ios::binary);
+    const std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+    if (!input.good() && !input.eof()) {
+        throw std::runtime_error{"Can't read image " + input_img.string()};
+    }
+
+    DecodedImage image{.path = input_img};
+    if (input_params.skeleton_cache) {
+        image.cache_key = ogr::cache::SkeletonCache::MakeKey(bytes, GetPreprocessingParams(input_params));
+        image.cached = input_params.skeleton_cache->Load(image.cache_key);
+        if (image.cached.has_value()) {
+            return image;
+        }
+    }
+
+    image.colored = cv::imdecode(bytes, cv::ImreadModes::IMREAD_COLOR);
+    if (image.colored.empty()) {
+        throw std::runtime_error{"Can't read image " + input_img.string()};
+    }
 
     LOG_INFO << "Image successfully read";
 
+    return image;
+}
+
+/** Step 2: thinning of whole image or by tiles, skeleton is returned as bits */
+std::vector<uint64_t> ThinImage(const DecodedImage& image, const InputCliParams& input_params) {
+    // Large images are thinned by tiles, so only tile sized buffers are allocated
+    return input_params.tile_size
+            ? ogr::thinning::GetTiledSkeletonBits(image.colored, input_params.tile_size, input_params.tile_halo, input_params.threads)
+            : ogr::thinning::GetSkeletonBits(image.colored, input_params.threads);
+}
+
+/** Steps 2-3.1: thinning and vertexes detection, result doesn't depend on algo params */
+ogr::OpticalGraphRecognition PrepareImage(DecodedImage image, const InputCliParams& input_params) {
+    const Fpath& input_img = image.path;
+
+    // Recognition is restored from cache here, so grids are built by preprocess workers
+    if (image.cached.has_value()) {
+        return ogr::OpticalGraphRecognition{image.cached->graph, input_img.filename(), GetGridOptions(input_params)};
+    }
+
+    const cv::Mat& colored_image = image.colored;
+
     // Step 2: Preprocess image and get thinning graph representation
-    cv::Mat thinning_image = ogr::opencv::GetThinningImage(grayscale_image);
+    const std::vector<uint64_t> skeleton_bits = ThinImage(image, input_params);
 
     LOG_INFO << "Image was thinned for morphological parsing";
 
-    // Step 3.0: Morphological parsing graph image
-    // Prepare ogr algo params
-    ogr::kStableStateAngleDiffLocalThreshold = ogr_params.curvature;
-    ogr::kStableStateAngleDiffThreshold = ogr_params.stable_diff;
-    ogr::kAngleDiffThreshold = ogr_params.state_diff;
+    // Step 3.0-3.1: Morphological parsing graph image: skeleton, inc usage and vertex points (detected by color)
+    // are taken from source and thinned images in single pass
+    const ogr::vertex::VertexPointsDetectorByColor vertex_detector(kVertexColor);
+    ogr::OpticalGraphRecognition ogr_algo{
+        ogr::IngestImage(colored_image, skeleton_bits, vertex_detector),
+        input_img.filename(),
+        GetGridOptions(input_params)
+    };
 
-    ogr::OpticalGraphRecognition ogr_algo{thinning_image, input_img.filename()};
-    ogr_algo.UpdateIncUsage(colored_image);
+    LOG_INFO << "Optical graph recognition initialized, all graph vertexes were detected from image";
 
-    LOG_INFO << "Optical graph recognition initialized";
+    if (input_params.skeleton_cache) {
+        input_params.skeleton_cache->Store(image.cache_key, ogr_algo);
+    }
 
-    // Step 3.1: Prepare vertex detecting strategy and use this strategy for detect vertexes in source image
-    ogr::vertex::VertexPointsDetectorByColor vertex_detector(colored_image, {0, 0, 0});
-    ogr_algo.DetectVertexes(vertex_detector);
+    return ogr_algo;
+}
+
+ogr::OpticalGraphRecognition PrepareImage(const Fpath& input_img, const InputCliParams& input_params) {
+    return PrepareImage(DecodeImage(input_img, input_params), input_params);
+}
 
-    LOG_INFO << "All graph vertexes were detected from image";
+/** Steps 3.2-5: edges detection with algo params, bundling and crossings evaluation */
+void RecognizeEdges(
+        ogr::OpticalGraphRecognition& ogr_algo,
+        const OgrParams& ogr_params,
+        const InputCliParams& input_params,
+        const ogr::crawler::CrawlerSizes& crawler_sizes) {
+    // Prepare ogr algo params (angles in degrees are converted to binary angles)
+    const ogr::AlgoParams algo_params = ogr::AlgoParams::FromDegrees(
+            ogr_params.curvature, ogr_params.stable_diff, ogr_params.state_diff);
 
     // Step 3.2: Detecting edges
     // Run algorithm of edges detecting
-    ogr_algo.DetectEdges(input_params.vertex);
+    LOG_INFO << "Crawler step size = " << crawler_sizes.step_size << " sub path steps = " << crawler_sizes.sub_path_steps_size;
+    ogr_algo.DetectEdges(
+            algo_params,
+            input_params.vertex,
+            input_params.locality_order,
+            input_params.threads,
+            input_params.beam_width,
+            crawler_sizes);
 
     if (ogr_params.union_strategy == "union") {
         ogr_algo.UnionFoundEdges();
@@ -92,27 +324,365 @@ ogr::OpticalGraphRecognition ProcessImage(const std::filesystem::path& input_img
     // Step 5: Aesthetics evaluation
     LOG_INFO << "Detect crossing points";
     ogr_algo.MarkCrossingsPoints();
+}
 
-    // Step 5: Print results
-
+/** Step 6: Print results */
+void DumpResults(ogr::OpticalGraphRecognition& ogr_algo, const Fpath& input_img, const InputCliParams& input_params) {
     // Dump algo results
     //    if (!ogr::debug::DevDirPath.empty()) {
     //        output_dir = std::filesystem::path(ogr::debug::DevDirPath);
     //    }
 
-    if (!input_params.only_report) {
-        Fpath output_dir = input_params.output_dir / input_img.stem();
-        if (!FS::exists(output_dir)) {
-            FS::create_directory(output_dir);
-        }
+    if (input_params.only_report) {
+        return;
+    }
 
-        ogr_algo.DumpResultImages(output_dir, input_params.dump_edges, input_params.vertex);
+    Fpath output_dir = input_params.output_dir / input_img.stem();
+    if (!FS::exists(output_dir)) {
+        FS::create_directory(output_dir);
     }
 
+    ogr_algo.DumpResultImages(output_dir, input_params.dump_edges, input_params.vertex);
+}
+
+ogr::OpticalGraphRecognition ProcessImage(
+        const std::filesystem::path& input_img,
+        const OgrParams& ogr_params,
+        const InputCliParams& input_params,
+        const ogr::crawler::CrawlerSizes& crawler_sizes) {
+    ogr::OpticalGraphRecognition ogr_algo = PrepareImage(input_img, input_params);
+    RecognizeEdges(ogr_algo, ogr_params, input_params, crawler_sizes);
+    DumpResults(ogr_algo, input_img, input_params);
+
     return ogr_algo;
 }
 
 
+/** Images of single input dir: bundling images are evaluated against baseline one */
+struct Dataset {
+    // Output dir of dataset is set in params
+    InputCliParams params;
+    Fpath baseline_path;
+    std::vector<Fpath> algo_images_paths;
+};
+
+/** Returns nullopt if filter is set: filtered image is processed right away */
+std::optional<Dataset> CollectDataset(const Fpath& input_dir, const Fpath& output_dir, const InputCliParams& cli_params) {
+    Dataset dataset{.params = cli_params};
+    dataset.params.output_dir = output_dir;
+
+    for (const auto file : FS::directory_iterator{input_dir}) {
+        Fpath file_path = file.path();
+        const std::string stemmed_name = file_path.stem();
+
+        if (file_path.extension() == kMetaExtension) {
+            continue;
+        }
+
+        if (cli_params.filter.has_value() && stemmed_name == *cli_params.filter) {
+            OgrParams ogr_params = *cli_params.filter == cli_params.baseline_name ? cli_params.ogr_baseline_params : cli_params.ogr_algo_params;
+            ProcessImage(file_path, ogr_params, dataset.params, GetImageCrawlerSizes(file_path, cli_params));
+            return std::nullopt;
+        }
+
+        if (stemmed_name == cli_params.baseline_name) {
+            dataset.baseline_path = std::move(file_path);
+            continue;
+        }
+
+        dataset.algo_images_paths.emplace_back(std::move(file_path));
+    }
+
+    if (cli_params.filter.has_value()) {
+        return std::nullopt;
+    }
+
+    if (!FS::exists(dataset.baseline_path)) {
+        throw std::runtime_error{"Baseline not valid path in " + input_dir.string()};
+    }
+
+    return dataset;
+}
+
+Fpath GetSnapshotPath(const Fpath& image_path, const InputCliParams& input_params) {
+    return input_params.output_dir / (image_path.stem().string() + kSnapshotExtension);
+}
+
+/** Image without snapshot (e.g. new one of dataset) is recognized, its snapshot is saved with --save-snapshots */
+bool ReuseSnapshot(const Fpath& image_path, const size_t index, const InputCliParams& input_params) {
+    if (input_params.reuse_snapshots != "all" && (input_params.reuse_snapshots != "baseline" || index)) {
+        return false;
+    }
+
+    if (!FS::exists(GetSnapshotPath(image_path, input_params))) {
+        LOG_INFO << "Snapshot of " << image_path << " is missing, image is recognized";
+        return false;
+    }
+
+    return true;
+}
+
+/** Baseline is recognized once and can be reused from its snapshot by later runs */
+ogr::Snapshot GetBaselineSnapshot(const Dataset& dataset) {
+    const InputCliParams& params = dataset.params;
+    const Fpath snapshot_path = GetSnapshotPath(dataset.baseline_path, params);
+    if (ReuseSnapshot(dataset.baseline_path, 0, params)) {
+        return ogr::Snapshot::Open(snapshot_path);
+    }
+
+    const ogr::OpticalGraphRecognition baseline_algo = ProcessImage(
+            dataset.baseline_path,
+            params.ogr_baseline_params,
+            params,
+            GetImageCrawlerSizes(dataset.baseline_path, params));
+
+    ogr::Snapshot baseline = ogr::snapshot::MakeSnapshot(baseline_algo);
+    if (params.save_snapshots) {
+        baseline.Write(snapshot_path);
+    }
+
+    return baseline;
+}
+
+/** Every image of dataset is processed with every precompiled crawler sizes */
+void RunBenchmark(const Dataset& dataset, const ogr::Snapshot& baseline) {
+    // Connections of baseline as it's recognized for report (with its configured sizes or from snapshot) are reference for every run
+    InputCliParams benchmark_params = dataset.params;
+    benchmark_params.only_report = true;
+
+    std::vector<ogr::BenchmarkRecord> records;
+    for (const ogr::crawler::CrawlerSizes& crawler_sizes : ogr::crawler::SupportedCrawlerSizes()) {
+        auto run = [&](const Fpath& image_path, const OgrParams& ogr_params) {
+            const auto start = std::chrono::steady_clock::now();
+            ogr::OpticalGraphRecognition ogr_algo = ProcessImage(image_path, ogr_params, benchmark_params, crawler_sizes);
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+            records.push_back(ogr::BenchmarkRecord{
+                .filename = image_path.filename(),
+                .crawler_sizes = crawler_sizes,
+                .time_ms = elapsed.count(),
+                .edge_recall = ogr::GetEdgeRecall(ogr::snapshot::MakeSnapshot(ogr_algo), baseline)
+            });
+        };
+
+        run(dataset.baseline_path, dataset.params.ogr_baseline_params);
+        for (const auto& algo_image_path : dataset.algo_images_paths) {
+            run(algo_image_path, dataset.params.ogr_algo_params);
+        }
+    }
+
+    ogr::MakeBenchmarkReport(records);
+}
+
+/** Every combination of swept algo params is evaluated for every bundling image of dataset */
+void RunSweep(const Dataset& dataset, const ogr::Snapshot& baseline, const size_t jobs) {
+    const InputCliParams& cli_params = dataset.params;
+    const OgrParams& algo_params = cli_params.ogr_algo_params;
+    const std::vector<double> curvatures = ParseSweepValues(cli_params.sweep_curvature, algo_params.curvature);
+    const std::vector<double> stable_diffs = ParseSweepValues(cli_params.sweep_stable_diff, algo_params.stable_diff);
+    const std::vector<double> state_diffs = ParseSweepValues(cli_params.sweep_state_diff, algo_params.state_diff);
+
+    std::vector<OgrParams> combinations;
+    for (const double curvature : curvatures) {
+        for (const double stable_diff : stable_diffs) {
+            for (const double state_diff : state_diffs) {
+                OgrParams ogr_params = algo_params;
+                ogr_params.curvature = curvature;
+                ogr_params.stable_diff = stable_diff;
+                ogr_params.state_diff = state_diff;
+                combinations.push_back(ogr_params);
+            }
+        }
+    }
+
+    // Combinations are evaluated concurrently (each one detects edges in single thread)
+    const size_t workers = std::max(jobs, ogr::debug::DevDirPath.empty() ? cli_params.threads : 1);
+    InputCliParams combination_params = cli_params;
+    if (workers > 1) {
+        combination_params.threads = 1;
+    }
+    thread_pool pool(workers);
+
+    // Image is read, thinned and its vertexes are detected once, every combination starts from copy of this state
+    for (const auto& algo_image_path : dataset.algo_images_paths) {
+        const ogr::OpticalGraphRecognition prepared_algo = PrepareImage(algo_image_path, cli_params);
+        const ogr::crawler::CrawlerSizes crawler_sizes = GetImageCrawlerSizes(algo_image_path, cli_params);
+
+        std::vector<ogr::SweepRecord> records(combinations.size());
+        std::vector<std::future<void>> runs;
+        for (size_t i = 0; i < combinations.size(); ++i) {
+            runs.push_back(pool.submit([&, i]() {
+                const OgrParams& ogr_params = combinations[i];
+
+                const auto start = std::chrono::steady_clock::now();
+                ogr::OpticalGraphRecognition ogr_algo = prepared_algo;
+                RecognizeEdges(ogr_algo, ogr_params, combination_params, crawler_sizes);
+                const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+                const ogr::Snapshot snapshot = ogr::snapshot::MakeSnapshot(ogr_algo);
+                records[i] = ogr::SweepRecord{
+                    .curvature = ogr_params.curvature,
+                    .stable_diff = ogr_params.stable_diff,
+                    .state_diff = ogr_params.state_diff,
+                    .edges = snapshot.Edges().size(),
+                    .false_positive_connections = ogr::CountFalsePositiveConnections(snapshot, baseline),
+                    .crossings = snapshot.Crossings().size(),
+                    .time_ms = elapsed.count()
+                };
+            }));
+        }
+
+        for (auto& run : runs) {
+            run.get();
+        }
+
+        ogr::MakeSweepReport(algo_image_path.filename(), records);
+    }
+}
+
+/** Image on its way through pipeline stages */
+struct PipelineItem {
+    size_t dataset_index;
+    const Dataset* dataset;
+    // Position of image in dataset report, baseline goes first
+    size_t index;
+
+    std::optional<DecodedImage> decoded;
+    std::optional<ogr::OpticalGraphRecognition> ogr_algo;
+    std::optional<ogr::Snapshot> snapshot;
+
+    const Fpath& ImagePath() const {
+        return index ? dataset->algo_images_paths[index - 1] : dataset->baseline_path;
+    }
+
+    const OgrParams& Params() const {
+        return index ? dataset->params.ogr_algo_params : dataset->params.ogr_baseline_params;
+    }
+};
+
+struct PipelineStage {
+    std::string name;
+    size_t workers;
+    std::function<void(PipelineItem&)> handler;
+};
+
+/**
+ * Stages run concurrently and are connected by bounded queues: next images are decoded and thinned
+ * while previous ones are recognized and dumped, and only few images are in flight between stages.
+ * Items leave last stage in completion order, sink is called concurrently for different items.
+ */
+std::vector<ogr::PipelineStageRecord> RunPipeline(
+        std::vector<PipelineItem> items,
+        const std::vector<PipelineStage>& stages,
+        const size_t queue_capacity,
+        const std::function<void(PipelineItem&&)>& sink) {
+    using Queue = ogr::utils::BoundedQueue<PipelineItem>;
+    using Clock = std::chrono::steady_clock;
+    using Duration = std::chrono::duration<double, std::milli>;
+
+    // Input queue of first stage holds all pending images
+    std::vector<std::unique_ptr<Queue>> queues;
+    queues.push_back(std::make_unique<Queue>(items.size()));
+    for (PipelineItem& item : items) {
+        queues.front()->Push(std::move(item));
+    }
+    queues.front()->Close();
+
+    for (size_t i = 1; i < stages.size(); ++i) {
+        queues.push_back(std::make_unique<Queue>(queue_capacity));
+    }
+
+    struct StageState {
+        std::mutex mutex;
+        size_t running_workers{0};
+        size_t images{0};
+        Duration busy{0};
+        Clock::time_point finish;
+    };
+    std::vector<StageState> states(stages.size());
+
+    size_t workers_count = 0;
+    for (const PipelineStage& stage : stages) {
+        workers_count += stage.workers;
+    }
+
+    const auto start = Clock::now();
+    thread_pool pool(workers_count);
+    std::vector<std::future<void>> workers;
+    for (size_t s = 0; s < stages.size(); ++s) {
+        states[s].running_workers = stages[s].workers;
+
+        for (size_t w = 0; w < stages[s].workers; ++w) {
+            workers.push_back(pool.submit([&, s]() {
+                Queue& input = *queues[s];
+                Queue* output = s + 1 < queues.size() ? queues[s + 1].get() : nullptr;
+                StageState& state = states[s];
+
+                try {
+                    while (std::optional<PipelineItem> item = input.Pop()) {
+                        const auto item_start = Clock::now();
+                        stages[s].handler(*item);
+                        const Duration busy = Clock::now() - item_start;
+
+                        {
+                            std::lock_guard lock(state.mutex);
+                            ++state.images;
+                            state.busy += busy;
+                        }
+
+                        if (!output) {
+                            sink(std::move(*item));
+                        } else if (!output->Push(std::move(*item))) {
+                            break;
+                        }
+                    }
+                } catch (...) {
+                    // Stop whole pipeline: producers see closed queues, consumers drain them
+                    for (auto& queue : queues) {
+                        queue->Close();
+                    }
+                    throw;
+                }
+
+                // Last worker of stage closes its output, so next stage finishes after draining it
+                std::lock_guard lock(state.mutex);
+                if (!--state.running_workers) {
+                    state.finish = Clock::now();
+                    if (output) {
+                        output->Close();
+                    }
+                }
+            }));
+        }
+    }
+
+    for (auto& worker : workers) {
+        worker.get();
+    }
+
+    std::vector<ogr::PipelineStageRecord> records;
+    for (size_t s = 0; s < stages.size(); ++s) {
+        const Queue::Stats input_stats = queues[s]->GetStats();
+        const std::optional<Queue::Stats> output_stats = s + 1 < queues.size()
+                ? std::make_optional(queues[s + 1]->GetStats())
+                : std::nullopt;
+
+        records.push_back(ogr::PipelineStageRecord{
+            .name = stages[s].name,
+            .workers = stages[s].workers,
+            .images = states[s].images,
+            .busy_ms = states[s].busy.count(),
+            .wall_ms = Duration(states[s].finish - start).count(),
+            .input_wait_ms = input_stats.pop_wait.count(),
+            .output_wait_ms = output_stats ? output_stats->push_wait.count() : 0,
+            .output_queue_capacity = output_stats ? output_stats->capacity : 0,
+            .output_queue_max_size = output_stats ? output_stats->max_size : 0
+        });
+    }
+
+    return records;
+}
+
 int main(int argc, char* argv[]) {
     CLI::App app{"Aesthetic metrics evaluation of bundling visualization techniques"};
 
@@ -129,7 +699,7 @@ int main(int argc, char* argv[]) {
     };
 
     // General required params
-    app.add_option("-i,--input", cli_params.input_dir, "Input images dir path")
+    app.add_option("-i,--input", cli_params.input_dirs, "Input images dirs paths, every dir contains own baseline")
         ->required()
         ->check(check_path);
     app.add_option("-b,--baseline-name", cli_params.baseline_name, "Input image baseline")
@@ -155,6 +725,44 @@ int main(int argc, char* argv[]) {
     app.add_flag("--dump-edges", cli_params.dump_edges, "Dump detected edges images")
         ->default_val(false);
 
+    // Performance params
+    app.add_option("--grid-layout", cli_params.grid_layout, "Memory layout of recognition grid: row-major, tiled, sparse")
+        ->default_val("row-major");
+    app.add_option("--memory-budget", cli_params.memory_budget_mb, "Max size of recognition grid in memory, larger grids are spilled to file, edges detection workers are limited to fit their overlays, MB (0 is unlimited)")
+        ->default_val(0);
+    app.add_option("--spill-dir", cli_params.spill_dir, "Dir of spilled recognition grids")
+        ->default_val(FS::temp_directory_path());
+    app.add_option("--tile-size", cli_params.tile_size, "Side of tiles for thinning of large images, 0 to thin whole image")
+        ->default_val(0);
+    app.add_option("--tile-halo", cli_params.tile_halo, "Width of neighbour pixels thinned with every tile, should exceed strokes width")
+        ->default_val(64);
+    app.add_flag("--locality-order", cli_params.locality_order, "Detect edges of vertexes in Morton order of their centroids")
+        ->default_val(false);
+    app.add_option("--threads", cli_params.threads, "Threads count for parallel thinning and edges detection, in pipeline they are split across jobs")
+        ->default_val(1);
+    app.add_option("--jobs", cli_params.jobs, "Workers of every heavy pipeline stage (preprocess, recognise, dump), every worker gets max(1, threads / jobs) threads")
+        ->default_val(1);
+    app.add_option("--queue-capacity", cli_params.queue_capacity, "Max images waiting between pipeline stages")
+        ->default_val(2);
+    app.add_flag("--pipeline-stats", cli_params.pipeline_stats, "Report utilisation and back-pressure of pipeline stages")
+        ->default_val(false);
+    app.add_option("--cache-dir", cli_params.cache_dir, "Dir of thinned skeletons and detected vertexes cache")
+        ->default_val(std::nullopt);
+    app.add_option("--cache-size", cli_params.cache_size_mb, "Max size of skeletons cache, MB")
+        ->default_val(512);
+    app.add_flag("--save-snapshots", cli_params.save_snapshots, "Save snapshots of recognized images to output dir")
+        ->default_val(false);
+    app.add_option("--reuse-snapshots", cli_params.reuse_snapshots, "Take recognition results from snapshots in output dir instead of recognition (images without snapshot are recognized): none, baseline, all")
+        ->default_val("none");
+    app.add_option("--beam-width", cli_params.beam_width, "Max crawlers per depth for beam search of edges, 0 for exhaustive search")
+        ->default_val(0);
+    app.add_option("--step-size", cli_params.crawler_sizes.step_size, "Points in crawler step (can be set per image in meta file)")
+        ->default_val(10);
+    app.add_option("--sub-path-steps", cli_params.crawler_sizes.sub_path_steps_size, "Steps in crawler sub path (can be set per image in meta file)")
+        ->default_val(7);
+    app.add_flag("--benchmark", cli_params.benchmark, "Report time and edge recall of images for every precompiled crawler sizes")
+        ->default_val(false);
+
     // Ogr algo params
     auto* algo_input_params = app.add_option_group("Algo params", "Parameters of ogr algorithm");
 
@@ -180,6 +788,15 @@ int main(int argc, char* argv[]) {
     algo_input_params->add_option("--edges-union", cli_params.ogr_algo_params.union_strategy, "Union found edges strategy: union, intersection")
         ->default_val("union");
 
+    // Sweep of algo params: every combination is evaluated for every bundling image
+    auto* sweep_input_params = app.add_option_group("Sweep params", "Lists (10,15) or ranges (start:stop:step) of algo params values");
+    sweep_input_params->add_option("--sweep-curvature", cli_params.sweep_curvature, "Swept values of curvature")
+        ->default_val(std::nullopt);
+    sweep_input_params->add_option("--sweep-stable-diff", cli_params.sweep_stable_diff, "Swept values of stable diff")
+        ->default_val(std::nullopt);
+    sweep_input_params->add_option("--sweep-state-diff", cli_params.sweep_state_diff, "Swept values of state diff")
+        ->default_val(std::nullopt);
+
     CLI11_PARSE(app, argc, argv);
 
     static plog::ColorConsoleAppender<plog::TxtFormatter> consoleAppender{plog::OutputStream::streamStdErr};
@@ -192,38 +809,143 @@ int main(int argc, char* argv[]) {
         plog::init(plog::none, &consoleAppender);
     }
 
-    std::vector<Fpath> algo_images_paths;
-    Fpath baseline_path;
-    for (const auto file : FS::directory_iterator{cli_params.input_dir}) {
-        Fpath file_path = file.path();
-        const std::string stemmed_name = file_path.stem();
+    if (cli_params.reuse_snapshots != "none" && cli_params.reuse_snapshots != "baseline" && cli_params.reuse_snapshots != "all") {
+        throw std::runtime_error{"Invalid reuse-snapshots param, only 'none', 'baseline' or 'all' allowed"};
+    }
 
-        if (cli_params.filter.has_value() && stemmed_name == *cli_params.filter) {
-            OgrParams ogr_params = *cli_params.filter == cli_params.baseline_name ? cli_params.ogr_baseline_params : cli_params.ogr_algo_params;
-            ProcessImage(file_path, ogr_params, cli_params);
-            return 0;
+    // Angles above half turn are clamped to it, negative ones have no meaning
+    for (const OgrParams* ogr_params : {&cli_params.ogr_algo_params, &cli_params.ogr_baseline_params}) {
+        for (const double degrees : {ogr_params->curvature, ogr_params->stable_diff, ogr_params->state_diff}) {
+            if (!std::isfinite(degrees) || degrees < 0) {
+                throw std::runtime_error{"Invalid angle param " + std::to_string(degrees) + ", expected non negative number of degrees"};
+            }
         }
+    }
 
-        if (stemmed_name == cli_params.baseline_name) {
-            baseline_path = std::move(file_path);
-            continue;
+    if (cli_params.cache_dir.has_value()) {
+        cli_params.skeleton_cache = std::make_shared<ogr::cache::SkeletonCache>(
+                *cli_params.cache_dir, static_cast<uintmax_t>(cli_params.cache_size_mb) << 20);
+    }
+
+    // Intermediate results dumps are sequential
+    const size_t jobs = ogr::debug::DevDirPath.empty() ? std::max<size_t>(cli_params.jobs, 1) : 1;
+
+    // Outputs of several input dirs are separated by input dir name, so names should be unique
+    std::vector<Fpath> output_dirs;
+    std::set<Fpath> dataset_names;
+    for (const Fpath& input_dir : cli_params.input_dirs) {
+        output_dirs.push_back(cli_params.output_dir);
+        if (cli_params.input_dirs.size() > 1) {
+            const Fpath name = FS::canonical(input_dir).filename();
+            if (!dataset_names.insert(name).second) {
+                throw std::runtime_error{"Several input dirs are named " + name.string() + ", their outputs would overwrite each other"};
+            }
+
+            output_dirs.back() /= name;
+        }
+    }
+
+    std::vector<Dataset> datasets;
+    for (size_t i = 0; i < cli_params.input_dirs.size(); ++i) {
+        const Fpath& input_dir = cli_params.input_dirs[i];
+        const Fpath& output_dir = output_dirs[i];
+        FS::create_directories(output_dir);
+
+        std::optional<Dataset> dataset = CollectDataset(input_dir, output_dir, cli_params);
+        if (dataset.has_value()) {
+            datasets.push_back(std::move(*dataset));
+        }
+    }
+
+    if (cli_params.filter.has_value()) {
+        return 0;
+    }
+
+    const bool sweep = cli_params.sweep_curvature.has_value()
+            || cli_params.sweep_stable_diff.has_value()
+            || cli_params.sweep_state_diff.has_value();
+    if (cli_params.benchmark || sweep) {
+        for (const Dataset& dataset : datasets) {
+            const ogr::Snapshot baseline = GetBaselineSnapshot(dataset);
+
+            if (cli_params.benchmark) {
+                RunBenchmark(dataset, baseline);
+            } else {
+                RunSweep(dataset, baseline, jobs);
+            }
         }
 
-        algo_images_paths.emplace_back(std::move(file_path));
+        return 0;
     }
 
-    if (!FS::exists(baseline_path)) {
-        throw std::runtime_error{"Baseline not valid path"};
+    // Every worker of preprocess and recognise stages runs own thread pool, so threads are split across jobs
+    for (Dataset& dataset : datasets) {
+        dataset.params.threads = std::max<size_t>(cli_params.threads / jobs, 1);
+    }
+
+    // Images of all datasets go through single pipeline, baseline of dataset is needed only for its report.
+    // Only snapshots of recognized images are kept for reports, they are made in order of datasets and images,
+    // so output doesn't depend on completion order
+    std::vector<PipelineItem> items;
+    std::vector<std::vector<std::optional<ogr::Snapshot>>> results;
+    for (size_t i = 0; i < datasets.size(); ++i) {
+        const size_t images_count = datasets[i].algo_images_paths.size() + 1;
+        results.emplace_back(images_count);
+
+        for (size_t index = 0; index < images_count; ++index) {
+            PipelineItem item{.dataset_index = i, .dataset = &datasets[i], .index = index};
+            if (ReuseSnapshot(item.ImagePath(), index, datasets[i].params)) {
+                results[i][index] = ogr::Snapshot::Open(GetSnapshotPath(item.ImagePath(), datasets[i].params));
+                continue;
+            }
+
+            items.push_back(std::move(item));
+        }
     }
 
-    ogr::OpticalGraphRecognition baseline_algo = ProcessImage(baseline_path, cli_params.ogr_baseline_params, cli_params);
+    const std::vector<PipelineStage> stages = {
+        {"decode", 1, [](PipelineItem& item) {
+            item.decoded = DecodeImage(item.ImagePath(), item.dataset->params);
+        }},
+        {"preprocess", jobs, [](PipelineItem& item) {
+            item.ogr_algo = PrepareImage(std::move(*item.decoded), item.dataset->params);
+            item.decoded.reset();
+        }},
+        {"recognise", jobs, [](PipelineItem& item) {
+            const InputCliParams& params = item.dataset->params;
+            RecognizeEdges(*item.ogr_algo, item.Params(), params, GetImageCrawlerSizes(item.ImagePath(), params));
+        }},
+        {"dump", jobs, [](PipelineItem& item) {
+            const InputCliParams& params = item.dataset->params;
+            DumpResults(*item.ogr_algo, item.ImagePath(), params);
+
+            item.snapshot = ogr::snapshot::MakeSnapshot(*item.ogr_algo);
+            item.ogr_algo.reset();
+            if (params.save_snapshots) {
+                item.snapshot->Write(GetSnapshotPath(item.ImagePath(), params));
+            }
+        }}
+    };
+
+    const std::vector<ogr::PipelineStageRecord> stage_records = RunPipeline(
+            std::move(items), stages, cli_params.queue_capacity, [&results](PipelineItem&& item) {
+                results[item.dataset_index][item.index] = std::move(item.snapshot);
+            });
+
+    for (auto& dataset_results : results) {
+        const ogr::Snapshot& baseline = *dataset_results.front();
 
-    std::vector<ogr::OpticalGraphRecognition> evaluated_algos;
-    for (const auto& algo_image_path : algo_images_paths) {
-        evaluated_algos.emplace_back(ProcessImage(algo_image_path, cli_params.ogr_algo_params, cli_params));
+        std::vector<ogr::Snapshot> evaluated_algos;
+        for (size_t i = 1; i < dataset_results.size(); ++i) {
+            evaluated_algos.push_back(std::move(*dataset_results[i]));
+        }
+
+        ogr::MakeReport(baseline, evaluated_algos);
     }
 
-    ogr::MakeReport(baseline_algo, evaluated_algos);
+    if (cli_params.pipeline_stats) {
+        ogr::MakePipelineReport(stage_records);
+    }
 
     return 0;
 }